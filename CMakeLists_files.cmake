@@ -129,6 +129,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/discretization/ecfv/ecfvdiscretization.hh
              opm/models/discretization/ecfv/ecfvproperties.hh
              opm/models/flash/flashmodel.hh
+             opm/models/flash/flashnewtonmethod.hh
              opm/models/flash/flashintensivequantities.hh
              opm/models/flash/flashindices.hh
              opm/models/flash/flashlocalresidual.hh
@@ -154,6 +155,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/io/cubegridvanguard.hh
              opm/models/io/baseoutputwriter.hh
              opm/models/io/vtkmultiwriter.hh
+             opm/models/io/vtkappendedrawwriter.hh
              opm/models/io/vtkmultiphasemodule.hh
              opm/models/io/vtkdiscretefracturemodule.hh
              opm/models/io/vtkdiffusionmodule.hh
@@ -182,7 +184,9 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/ncp/ncpboundaryratevector.hh
              opm/models/nonlinear/nullconvergencewriter.hh
              opm/models/nonlinear/newtonmethod.hh
+             opm/models/nonlinear/timestepcontrollers.hh
              opm/models/parallel/mpiutil.hh
+             opm/models/parallel/reproduciblesum.hh
              opm/models/parallel/tasklets.hh
              opm/models/parallel/threadmanager.hh
              opm/models/parallel/gridcommhandles.hh
@@ -221,6 +225,8 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/utils/signum.hh
              opm/models/utils/genericguard.hh
              opm/models/utils/basicproperties.hh
+             opm/models/utils/dofreordering.hh
+             opm/models/utils/reorderedmapper.hh
              opm/simulators/linalg/parallelistlbackend.hh
              opm/simulators/linalg/weightedresidreductioncriterion.hh
              opm/simulators/linalg/vertexborderlistfromgrid.hh
@@ -237,10 +243,12 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/simulators/linalg/overlappingoperator.hh
              opm/simulators/linalg/elementborderlistfromgrid.hh
              opm/simulators/linalg/combinedcriterion.hh
+             opm/simulators/linalg/cprpreconditioner.hh
              opm/simulators/linalg/bicgstabsolver.hh
              opm/simulators/linalg/globalindices.hh
              opm/simulators/linalg/superlubackend.hh
              opm/simulators/linalg/matrixblock.hh
+             opm/simulators/linalg/matrixfreeoperator.hh
              opm/simulators/linalg/istlsolverwrappers.hh
              opm/simulators/linalg/overlaptypes.hh
              opm/simulators/linalg/overlappingpreconditioner.hh
@@ -12,7 +12,7 @@ usage() {
     echo "Usage:"
     echo
     echo "runTest.sh TEST_TYPE [TEST_ARGS]"
-    echo "where TEST_TYPE can either be --plain, --simulation, --spe1 or --parallel-simulation=\$NUM_CORES (is '$TEST_TYPE')."
+    echo "where TEST_TYPE can either be --plain, --simulation, --spe1, --parallel-simulation=\$NUM_CORES, --parallel-scaling=\$MAX_CORES or --reproducible-threads=\$MAX_THREADS (is '$TEST_TYPE')."
 };
 
 # this function clips the help message printed by an ewoms simulation
@@ -154,6 +154,88 @@ case "$TEST_TYPE" in
         exit 0
         ;;
 
+    "--parallel-scaling="*)
+        MAX_PROCS="${TEST_TYPE/--parallel-scaling=/}"
+
+        # run the simulation using 1, 2, 4, ..., MAX_PROCS processes and print the
+        # time required for the whole simulation and for the linear solver
+        echo "######################"
+        echo "# Strong scaling of '$TEST_NAME'"
+        echo "######################"
+        NUM_PROCS=1
+        while test "$NUM_PROCS" -le "$MAX_PROCS"; do
+            echo "executing \"mpirun -np \"$NUM_PROCS\" $TEST_BINARY $TEST_ARGS\""
+            mpirun -np "$NUM_PROCS" "$TEST_BINARY" $TEST_ARGS > "test-$RND.log"
+            RET="$?"
+            if test "$RET" != "0"; then
+                echo "Executing the binary failed!"
+                cat "test-$RND.log"
+                rm "test-$RND.log"
+                exit 1
+            fi
+
+            SIM_TIME=$(grep "Simulation time:" "test-$RND.log" | head -n1 | sed "s/.*Simulation time: *\([0-9.e+\-]*\).*/\1/")
+            SOLVE_TIME=$(grep "Linear solve time:" "test-$RND.log" | head -n1 | sed "s/.*Linear solve time: *\([0-9.e+\-]*\).*/\1/")
+            rm "test-$RND.log"
+
+            printf "processes: %4i, simulation time: %s seconds, linear solve time: %s seconds\n" \
+                   "$NUM_PROCS" "$SIM_TIME" "$SOLVE_TIME"
+
+            NUM_PROCS=$(( 2*NUM_PROCS ))
+        done
+        exit 0
+        ;;
+
+    "--reproducible-threads="*)
+        MAX_THREADS="${TEST_TYPE/--reproducible-threads=/}"
+
+        # run the simulation using 1, 2, 4, ..., MAX_THREADS threads with reproducible
+        # sums and make sure that the convergence histories of the Newton method are
+        # identical
+        echo "######################"
+        echo "# Reproducibility of '$TEST_NAME' for different numbers of threads"
+        echo "######################"
+        NUM_THREADS=1
+        while test "$NUM_THREADS" -le "$MAX_THREADS"; do
+            echo "executing \"$TEST_BINARY $TEST_ARGS --threads-per-process=$NUM_THREADS --enable-reproducible-sums=true\""
+            "$TEST_BINARY" $TEST_ARGS --threads-per-process="$NUM_THREADS" --enable-reproducible-sums=true > "test-$RND.log" 2>&1
+            RET="$?"
+            if test "$RET" != "0"; then
+                if test "$NUM_THREADS" -gt 1 && grep -q "OpenMP is not available" "test-$RND.log"; then
+                    echo "OpenMP is not available, skipping the runs with multiple threads"
+                    rm "test-$RND.log"
+                    break
+                fi
+
+                echo "Executing the binary failed!"
+                cat "test-$RND.log"
+                rm -f "test-$RND.log" "test-$RND-history"*
+                exit 1
+            fi
+
+            grep "Newton iteration [0-9]* error:" "test-$RND.log" > "test-$RND-history-$NUM_THREADS"
+            rm "test-$RND.log"
+
+            if ! test -s "test-$RND-history-$NUM_THREADS"; then
+                echo "The simulation did not print any Newton iterations"
+                rm -f "test-$RND-history"*
+                exit 1
+            fi
+
+            if ! cmp -s "test-$RND-history-1" "test-$RND-history-$NUM_THREADS"; then
+                echo "The Newton convergence histories for 1 and $NUM_THREADS threads differ:"
+                diff "test-$RND-history-1" "test-$RND-history-$NUM_THREADS" | head -n 20
+                rm -f "test-$RND-history"*
+                exit 1
+            fi
+
+            echo "Newton convergence history for $NUM_THREADS threads: identical ($(wc -l < "test-$RND-history-$NUM_THREADS") iterations)"
+            NUM_THREADS=$(( 2*NUM_THREADS ))
+        done
+        rm -f "test-$RND-history"*
+        exit 0
+        ;;
+
     "--spe1")
         echo "Running the ebos simulator for SPE1CASE1"
 
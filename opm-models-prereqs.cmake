@@ -6,6 +6,7 @@ set(DUNE_AVOID_CAPABILITIES_IS_PARALLEL_DEPRECATION_WARNING 1)
 set (opm-models_CONFIG_VAR
   HAVE_QUAD
   HAVE_VALGRIND
+  HAVE_ZLIB
   HAVE_DUNE_COMMON
   HAVE_DUNE_GEOMETRY
   HAVE_DUNE_GRID
@@ -38,6 +39,8 @@ set (opm-models_DEPS
   "Valgrind"
   # quadruple precision floating point calculations
   "Quadmath"
+  # compression of the VTK output
+  "ZLIB"
   )
 
 find_package_deps(opm-models)
@@ -55,6 +55,7 @@
 #include <opm/material/common/Unused.hpp>
 #include <opm/material/common/Exceptions.hpp>
 
+#include <algorithm>
 #include <sstream>
 #include <string>
 
@@ -417,6 +418,34 @@ public:
         return 1.0;
     }
 
+    /*!
+     * \copydoc FvBaseDiscretization::primaryVarsExtrapolable
+     */
+    bool primaryVarsExtrapolable(const PrimaryVariables& priVars1,
+                                 const PrimaryVariables& priVars2) const
+    { return priVars1.primaryVarsMeaning() == priVars2.primaryVarsMeaning(); }
+
+    /*!
+     * \copydoc FvBaseDiscretization::limitExtrapolatedPrimaryVars
+     */
+    void limitExtrapolatedPrimaryVars(PrimaryVariables& priVars,
+                                      const PrimaryVariables& oldPriVars OPM_UNUSED) const
+    {
+        if (waterEnabled) {
+            Scalar& Sw = priVars[Indices::waterSaturationIdx];
+            Sw = std::max<Scalar>(0.0, std::min<Scalar>(1.0, Sw));
+        }
+
+        if (compositionSwitchEnabled) {
+            // the switching variable is either the gas saturation or one of the
+            // dissolution factors. neither of them can become negative
+            Scalar& x = priVars[Indices::compositionSwitchIdx];
+            x = std::max<Scalar>(0.0, x);
+            if (priVars.primaryVarsMeaning() == PrimaryVariables::Sw_po_Sg)
+                x = std::min<Scalar>(1.0, x);
+        }
+    }
+
     /*!
      * \brief Write the current solution for a degree of freedom to a
      *        restart file.
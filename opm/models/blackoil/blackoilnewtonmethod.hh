@@ -174,6 +174,24 @@ public:
     }
 
 protected:
+    /*!
+     * \copydoc NewtonMethod::saveUpdateState_
+     */
+    void saveUpdateState_()
+    {
+        numPriVarsSwitchedBeforeUpdate_ = numPriVarsSwitched_;
+        wasSwitchedBeforeUpdate_ = wasSwitched_;
+    }
+
+    /*!
+     * \copydoc NewtonMethod::restoreUpdateState_
+     */
+    void restoreUpdateState_()
+    {
+        numPriVarsSwitched_ = numPriVarsSwitchedBeforeUpdate_;
+        wasSwitched_ = wasSwitchedBeforeUpdate_;
+    }
+
     /*!
      * \copydoc FvBaseNewtonMethod::updatePrimaryVariables_
      */
@@ -323,6 +341,11 @@ private:
     // keep track of cells where the primary variable meaning has changed
     // to detect and hinder oscillations
     std::vector<bool> wasSwitched_;
+
+    // the state of the primary variable switching before the update of the current
+    // iteration. the line search needs this to try updates of different lengths.
+    int numPriVarsSwitchedBeforeUpdate_;
+    std::vector<bool> wasSwitchedBeforeUpdate_;
 };
 } // namespace Opm
 
@@ -42,6 +42,8 @@
 #include <dune/common/fmatrix.hh>
 
 #include <cmath>
+#include <utility>
+#include <vector>
 
 BEGIN_PROPERTIES
 
@@ -87,6 +89,12 @@ class ForchheimerBaseProblem
 {
     typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
     typedef typename GET_PROP_TYPE(TypeTag, Evaluation) Evaluation;
+    typedef typename GET_PROP_TYPE(TypeTag, GridView) GridView;
+
+    enum { dimWorld = GridView::dimensionworld };
+    enum { numPhases = GET_PROP_VALUE(TypeTag, NumPhases) };
+
+    typedef Dune::FieldVector<Scalar, dimWorld> DimVector;
 
 public:
     /*!
@@ -125,6 +133,73 @@ public:
     {
         return 1.0 / context.intensiveQuantities(spaceIdx, timeIdx).fluidState().viscosity(phaseIdx);
     }
+
+    /*!
+     * \brief Returns the Forchheimer velocity of a phase which was computed last for an
+     *        interior face of an element.
+     *
+     * If no velocity is available, 0 is returned.
+     *
+     * \param elemIdx The index of the element given by the element mapper
+     * \param faceIdx The local index of the interior face of the element's stencil
+     * \param phaseIdx The index of the fluid phase
+     */
+    const DimVector* forchheimerVelocityHint(unsigned elemIdx,
+                                             unsigned faceIdx,
+                                             unsigned phaseIdx) const
+    {
+        if (elemIdx >= velocityCache_.size())
+            return 0;
+
+        const auto& elemCache = velocityCache_[elemIdx];
+        unsigned idx = faceIdx*numPhases + phaseIdx;
+        if (idx >= elemCache.size() || !elemCache[idx].second)
+            return 0;
+
+        return &elemCache[idx].first;
+    }
+
+    /*!
+     * \brief Stores the Forchheimer velocity of a phase for an interior face of an
+     *        element.
+     *
+     * The cache is only modified by the thread which currently deals with the element,
+     * so no locking is required.
+     */
+    void storeForchheimerVelocity(unsigned elemIdx,
+                                  unsigned faceIdx,
+                                  unsigned phaseIdx,
+                                  const DimVector& velocity) const
+    {
+        if (elemIdx >= velocityCache_.size())
+            return;
+
+        auto& elemCache = velocityCache_[elemIdx];
+        unsigned idx = faceIdx*numPhases + phaseIdx;
+        if (idx >= elemCache.size())
+            elemCache.resize(idx + 1, std::make_pair(DimVector(0.0), false));
+        elemCache[idx] = std::make_pair(velocity, true);
+    }
+
+    /*!
+     * \brief Called by the problem before each Newton-Raphson iteration.
+     *
+     * This makes sure that the cache of the Forchheimer velocities exhibits an entry for
+     * each element of the grid. It must not be called concurrently with the
+     * linearization.
+     */
+    void beginFluxIteration(size_t numElements)
+    {
+        if (velocityCache_.size() != numElements) {
+            velocityCache_.clear();
+            velocityCache_.resize(numElements);
+        }
+    }
+
+private:
+    // the velocities of the last Forchheimer solve for each element, interior face and
+    // phase. the flag specifies whether the entry is valid.
+    mutable std::vector<std::vector<std::pair<DimVector, bool> > > velocityCache_;
 };
 
 /*!
@@ -399,7 +474,7 @@ protected:
                 continue;
             }
 
-            calculateForchheimerFlux_(phaseIdx);
+            calculateForchheimerFlux_(elemCtx, static_cast<int>(scvfIdx), phaseIdx);
 
             this->volumeFlux_[phaseIdx] = 0.0;
             for (unsigned dimIdx = 0; dimIdx < dimWorld; ++ dimIdx)
@@ -428,7 +503,7 @@ protected:
                 continue;
             }
 
-            calculateForchheimerFlux_(phaseIdx);
+            calculateForchheimerFlux_(elemCtx, /*scvfIdx=*/-1, phaseIdx);
 
             this->volumeFlux_[phaseIdx] = 0.0;
             for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
@@ -437,11 +512,38 @@ protected:
         }
     }
 
-    void calculateForchheimerFlux_(unsigned phaseIdx)
+    /*!
+     * \brief Calculate the Forchheimer velocity of a phase.
+     *
+     * If the permeability is isotropic, the velocity is determined analytically.
+     * Otherwise, the Forchheimer equation is solved using the Newton method. For
+     * interior faces, the velocity of the previous evaluation is used as the initial
+     * guess in this case.
+     *
+     * \param scvfIdx The local index of the interior face or -1 for boundary faces
+     */
+    void calculateForchheimerFlux_(const ElementContext& elemCtx, int scvfIdx, unsigned phaseIdx)
     {
-        // initial guess: filter velocity is zero
         DimEvalVector& velocity = this->filterVelocity_[phaseIdx];
+
+        if (isIsotropic_()) {
+            calculateIsotropicForchheimerFlux_(phaseIdx);
+            return;
+        }
+
+        // initial guess: the velocity computed by the previous solve of the Forchheimer
+        // equation for the face if available, else zero
+        const auto& problem = elemCtx.problem();
+        unsigned elemIdx = 0;
         velocity = 0.0;
+        if (scvfIdx >= 0) {
+            elemIdx = static_cast<unsigned>(elemCtx.model().elementMapper().index(elemCtx.element()));
+            const auto* hint = problem.forchheimerVelocityHint(elemIdx, static_cast<unsigned>(scvfIdx), phaseIdx);
+            if (hint) {
+                for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+                    velocity[dimIdx] = (*hint)[dimIdx];
+            }
+        }
 
         // the change of velocity between two consecutive Newton iterations
         DimEvalVector deltaV(1e5);
@@ -466,6 +568,55 @@ protected:
             gradResid.solve(deltaV, residual);
             velocity -= deltaV;
         }
+
+        if (scvfIdx >= 0) {
+            DimVector tmp;
+            for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+                tmp[dimIdx] = Toolbox::value(velocity[dimIdx]);
+            problem.storeForchheimerVelocity(elemIdx, static_cast<unsigned>(scvfIdx), phaseIdx, tmp);
+        }
+    }
+
+    /*!
+     * \brief Calculate the Forchheimer velocity of a phase for an isotropic
+     *        permeability.
+     *
+     * In this case, the Forchheimer equation
+     * \f[ \vec{v} + a |\vec{v}| \vec{v} = \vec{w} \f]
+     * with \f$\vec{w} = - \lambda K (\nabla p - \rho \vec{g})\f$ and \f$a = \rho
+     * \lambda/\eta_r C_E \sqrt{K}\f$ implies that \f$\vec{v}\f$ is parallel to
+     * \f$\vec{w}\f$, so the magnitude of the velocity is the positive root of
+     * \f$a |\vec{v}|^2 + |\vec{v}| - |\vec{w}| = 0\f$.
+     */
+    void calculateIsotropicForchheimerFlux_(unsigned phaseIdx)
+    {
+        DimEvalVector& velocity = this->filterVelocity_[phaseIdx];
+
+        const auto& mobility = this->mobility_[phaseIdx];
+        const auto& pGrad = this->potentialGrad_[phaseIdx];
+
+        // the Darcy velocity
+        Evaluation absW = 0.0;
+        for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx) {
+            velocity[dimIdx] = - mobility*pGrad[dimIdx]*this->K_[dimIdx][dimIdx];
+            absW += velocity[dimIdx]*velocity[dimIdx];
+        }
+
+        // the derivatives of the square root of 0 are undefined. since the Forchheimer
+        // velocity equals the Darcy velocity to first order for vanishing velocities,
+        // we are done in this case.
+        if (absW <= 0.0)
+            return;
+        absW = Toolbox::sqrt(absW);
+
+        const auto& a =
+            density_[phaseIdx]*mobilityPassabilityRatio_[phaseIdx]*ergunCoefficient_*sqrtK_[0];
+
+        // use the numerically stable form of the quadratic formula
+        const auto& absV = 2.0*absW/(1.0 + Toolbox::sqrt(1.0 + 4.0*a*absW));
+        const auto& factor = 1.0/(1.0 + a*absV);
+        for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+            velocity[dimIdx] *= factor;
     }
 
     void forchheimerResid_(DimEvalVector& residual, unsigned phaseIdx) const
@@ -536,6 +687,18 @@ protected:
         }
     }
 
+    /*!
+     * \brief Check whether the square root of the diagonal permeability is the same in
+     *        all directions.
+     */
+    bool isIsotropic_() const
+    {
+        for (unsigned dimIdx = 1; dimIdx < dimWorld; ++dimIdx)
+            if (std::abs(sqrtK_[dimIdx] - sqrtK_[0]) > 1e-10*sqrtK_[0])
+                return false;
+        return true;
+    }
+
     /*!
      * \brief Check whether all off-diagonal entries of a tensor are zero.
      *
@@ -122,6 +122,9 @@ SET_TYPE_PROP(MultiPhaseBaseModel,
 //! disable gravity by default
 SET_BOOL_PROP(MultiPhaseBaseModel, EnableGravity, false);
 
+//! do not cache the spatial parameters of the problem by default
+SET_BOOL_PROP(MultiPhaseBaseModel, EnableStaticDataCache, false);
+
 
 END_PROPERTIES
 
@@ -32,6 +32,7 @@
 
 #include <opm/models/discretization/common/fvbaseproblem.hh>
 #include <opm/models/discretization/common/fvbaseproperties.hh>
+#include <opm/models/utils/pffgridvector.hh>
 
 #include <opm/material/fluidmatrixinteractions/NullMaterial.hpp>
 #include <opm/material/common/Means.hpp>
@@ -41,12 +42,17 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <memory>
+
 BEGIN_PROPERTIES
 
 NEW_PROP_TAG(SolidEnergyLawParams);
 NEW_PROP_TAG(ThermalConductionLawParams);
 NEW_PROP_TAG(EnableGravity);
+NEW_PROP_TAG(EnableStaticDataCache);
 NEW_PROP_TAG(FluxModule);
+NEW_PROP_TAG(Stencil);
+NEW_PROP_TAG(DofMapper);
 
 END_PROPERTIES
 
@@ -65,6 +71,7 @@ class MultiPhaseBaseProblem
 {
 //! \cond SKIP_THIS
     typedef Opm::FvBaseProblem<TypeTag> ParentType;
+    typedef typename GET_PROP_TYPE(TypeTag, FluxModule)::FluxBaseProblem FluxBaseProblem;
 
     typedef typename GET_PROP_TYPE(TypeTag, Problem) Implementation;
     typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
@@ -75,6 +82,9 @@ class MultiPhaseBaseProblem
     typedef typename GET_PROP_TYPE(TypeTag, SolidEnergyLawParams) SolidEnergyLawParams;
     typedef typename GET_PROP_TYPE(TypeTag, ThermalConductionLawParams) ThermalConductionLawParams;
     typedef typename GET_PROP_TYPE(TypeTag, MaterialLaw)::Params MaterialLawParams;
+    typedef typename GET_PROP_TYPE(TypeTag, Stencil) Stencil;
+    typedef typename GET_PROP_TYPE(TypeTag, DofMapper) DofMapper;
+    typedef typename GridView::template Codim<0>::Entity Element;
 
     enum { dimWorld = GridView::dimensionworld };
     enum { numPhases = GET_PROP_VALUE(TypeTag, NumPhases) };
@@ -82,6 +92,21 @@ class MultiPhaseBaseProblem
     typedef Dune::FieldMatrix<Scalar, dimWorld, dimWorld> DimMatrix;
 //! \endcond
 
+public:
+    /*!
+     * \brief The spatial parameters of a degree of freedom which are cached if the
+     *        EnableStaticDataCache parameter is set.
+     */
+    struct StaticDofData
+    {
+        DimMatrix intrinsicPermeability;
+        Scalar porosity;
+        const MaterialLawParams* materialLawParams;
+    };
+
+private:
+    typedef Opm::PffGridVector<GridView, Stencil, StaticDofData, DofMapper> StaticDataVector;
+
 public:
     /*!
      * \copydoc Problem::FvBaseProblem(Simulator& )
@@ -99,6 +124,77 @@ public:
 
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableGravity,
                              "Use the gravity correction for the pressure gradients.");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableStaticDataCache,
+                             "Cache the intrinsic permeabilities, porosities and material "
+                             "law parameters of the problem. Only valid if they do not "
+                             "change over time.");
+    }
+
+    /*!
+     * \brief Handle changes of the grid.
+     */
+    void gridChanged()
+    {
+        ParentType::gridChanged();
+
+        if (staticDataCache_)
+            updateStaticDataCache_();
+    }
+
+    /*!
+     * \brief Prefetch the cached spatial parameters of an element.
+     */
+    void prefetch(const Element& elem) const
+    {
+        ParentType::prefetch(elem);
+
+        if (staticDataCache_)
+            staticDataCache_->prefetch(elem);
+    }
+
+    /*!
+     * \brief Return the cached spatial parameters of a degree of freedom of an
+     *        element context.
+     *
+     * If the parameters are not cached, a null pointer is returned. This is always the
+     * case for contexts which are not element contexts, e.g. for boundary contexts.
+     *
+     * \param elemCtx The element context of the degree of freedom
+     * \param dofIdx The local index of the degree of freedom in the element context
+     * \param timeIdx The index used by the time discretization.
+     */
+    const StaticDofData* cachedStaticDofData(const ElementContext& elemCtx,
+                                             unsigned dofIdx,
+                                             unsigned timeIdx OPM_UNUSED) const
+    {
+        if (!staticDataCache_)
+            return 0;
+
+        return &staticDataCache_->get(elemCtx.element(), dofIdx);
+    }
+
+    /*!
+     * \brief Return the cached spatial parameters of a degree of freedom.
+     *
+     * This overload is used for contexts which are not element contexts, so the
+     * parameters are never cached.
+     */
+    template <class Context>
+    const StaticDofData* cachedStaticDofData(const Context& context OPM_UNUSED,
+                                             unsigned spaceIdx OPM_UNUSED,
+                                             unsigned timeIdx OPM_UNUSED) const
+    { return 0; }
+
+    /*!
+     * \brief Called by the simulator before each Newton-Raphson iteration.
+     */
+    void beginIteration()
+    {
+        ParentType::beginIteration();
+
+        beginFluxIteration_(static_cast<FluxBaseProblem&>(*this),
+                            static_cast<size_t>(this->gridView().size(/*codim=*/0)),
+                            /*dummy=*/0);
     }
 
     /*!
@@ -386,6 +482,46 @@ protected:
         return ret;
     }
 
+    /*!
+     * \brief Store the intrinsic permeabilities, porosities and material law
+     *        parameters of all degrees of freedom in a prefetch friendly cache.
+     *
+     * This is a no-op unless the EnableStaticDataCache parameter is set. Problems which
+     * want to use the cache call this method at the end of their finishInit() method,
+     * i.e., after their spatial parameters have been set up, and let their
+     * intrinsicPermeability(), porosity() and materialLawParams() methods return the
+     * values provided by cachedStaticDofData() if it is not null. The parameter objects
+     * returned by materialLawParams() must stay alive as long as the problem.
+     */
+    void updateStaticDataCache_()
+    {
+        if (!EWOMS_GET_PARAM(TypeTag, bool, EnableStaticDataCache))
+            return;
+
+        // the problem's methods must not use the old cache while it is updated
+        staticDataCache_.reset();
+
+        std::unique_ptr<StaticDataVector> cache(new StaticDataVector(this->gridView(),
+                                                                     this->model().dofMapper()));
+        ElementContext elemCtx(this->simulator());
+        cache->update([this, &elemCtx](StaticDofData& data,
+                                       const Stencil& stencil,
+                                       unsigned localDofIdx)
+                      {
+                          if (localDofIdx == 0)
+                              elemCtx.updateStencil(stencil.element());
+
+                          const auto& problem = this->asImp_();
+                          data.intrinsicPermeability =
+                              problem.intrinsicPermeability(elemCtx, localDofIdx, /*timeIdx=*/0);
+                          data.porosity = problem.porosity(elemCtx, localDofIdx, /*timeIdx=*/0);
+                          data.materialLawParams =
+                              &problem.materialLawParams(elemCtx, localDofIdx, /*timeIdx=*/0);
+                      });
+
+        staticDataCache_ = std::move(cache);
+    }
+
     DimVector gravity_;
 
 private:
@@ -396,12 +532,25 @@ private:
     const Implementation& asImp_() const
     { return *static_cast<const Implementation *>(this); }
 
+    // notify the part of the problem provided by the flux module about a new Newton
+    // iteration if it is interested in this
+    template <class FluxProblem>
+    static auto beginFluxIteration_(FluxProblem& fluxProblem, size_t numElements, int)
+        -> decltype(fluxProblem.beginFluxIteration(numElements))
+    { return fluxProblem.beginFluxIteration(numElements); }
+
+    template <class FluxProblem>
+    static void beginFluxIteration_(FluxProblem& fluxProblem OPM_UNUSED, size_t numElements OPM_UNUSED, long)
+    { }
+
     void init_()
     {
         gravity_ = 0.0;
         if (EWOMS_GET_PARAM(TypeTag, bool, EnableGravity))
             gravity_[dimWorld-1]  = -9.81;
     }
+
+    std::unique_ptr<StaticDataVector> staticDataCache_;
 };
 
 } // namespace Opm
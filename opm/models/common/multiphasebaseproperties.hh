@@ -64,6 +64,15 @@ NEW_PROP_TAG(FluxModule);
 //! Returns whether gravity is considered in the problem
 NEW_PROP_TAG(EnableGravity);
 
+/*!
+ * \brief Specify whether the intrinsic permeabilities, porosities and material law
+ *        parameters of the problem should be cached.
+ *
+ * This is only valid if these quantities do not change over time, see
+ * MultiPhaseBaseProblem::updateStaticDataCache_().
+ */
+NEW_PROP_TAG(EnableStaticDataCache);
+
 END_PROPERTIES
 
 #endif
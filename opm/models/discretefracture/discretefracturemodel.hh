@@ -125,6 +125,11 @@ public:
             throw std::runtime_error("The discrete fracture model does not work in conjunction "
                                      "with intensive quantities caching");
         }
+
+        // the fracture mapper of the vanguard uses the vertex indices of the grid
+        if (this->vertexMapper().isReordered())
+            throw std::runtime_error("The discrete fracture model does not work in conjunction "
+                                     "with reordered degrees of freedom");
     }
 
     /*!
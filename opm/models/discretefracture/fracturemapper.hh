@@ -31,6 +31,7 @@
 
 #include <algorithm>
 #include <set>
+#include <vector>
 
 namespace Opm {
 
@@ -63,6 +64,7 @@ public:
      * \brief Constructor
      */
     FractureMapper()
+        : finalized_(false)
     {}
 
     /*!
@@ -76,6 +78,56 @@ public:
         fractureEdges_.insert(FractureEdge(vertexIdx1, vertexIdx2));
         fractureVertices_.insert(vertexIdx1);
         fractureVertices_.insert(vertexIdx2);
+
+        // the flat representation of the fracture topology is no longer up to date
+        finalized_ = false;
+    }
+
+    /*!
+     * \brief Create a flat representation of the fracture topology.
+     *
+     * This method should be called once all fracture edges have been
+     * added. Afterwards, the queries for fracture vertices and edges
+     * are done using a vertex bitmap and a list of the fracture
+     * neighbors of each vertex in compressed row storage format
+     * instead of walking through the trees of std::set.
+     */
+    void finalize()
+    {
+        unsigned numVertices = 0;
+        if (!fractureVertices_.empty())
+            numVertices = *fractureVertices_.rbegin() + 1;
+
+        // the bitmap for the fracture vertices
+        vertexIsFracture_.assign(numVertices, 0);
+        for (unsigned vertexIdx : fractureVertices_)
+            vertexIsFracture_[vertexIdx] = 1;
+
+        // the fracture neighbors of each vertex. since each edge is
+        // stored for both of its vertices, the number of neighbors of
+        // a vertex is counted first...
+        neighborOffsets_.assign(numVertices + 1, 0);
+        for (const auto& edge : fractureEdges_) {
+            ++neighborOffsets_[edge.i_ + 1];
+            ++neighborOffsets_[edge.j_ + 1];
+        }
+        for (unsigned vertexIdx = 0; vertexIdx < numVertices; ++vertexIdx)
+            neighborOffsets_[vertexIdx + 1] += neighborOffsets_[vertexIdx];
+
+        // ... then the neighbor indices are filled in. since the
+        // edges are sorted, the neighbors of each vertex are sorted
+        // as well.
+        neighborIndices_.resize(neighborOffsets_[numVertices]);
+        std::vector<unsigned> fillPos(neighborOffsets_.begin(), neighborOffsets_.end() - 1);
+        for (const auto& edge : fractureEdges_)
+            neighborIndices_[fillPos[edge.i_]++] = edge.j_;
+        for (const auto& edge : fractureEdges_)
+            neighborIndices_[fillPos[edge.j_]++] = edge.i_;
+        for (unsigned vertexIdx = 0; vertexIdx < numVertices; ++vertexIdx)
+            std::sort(neighborIndices_.begin() + neighborOffsets_[vertexIdx],
+                      neighborIndices_.begin() + neighborOffsets_[vertexIdx + 1]);
+
+        finalized_ = true;
     }
 
     /*!
@@ -84,7 +136,12 @@ public:
      * \param vertexIdx The index of the vertex.
      */
     bool isFractureVertex(unsigned vertexIdx) const
-    { return fractureVertices_.count(vertexIdx) > 0; }
+    {
+        if (!finalized_)
+            return fractureVertices_.count(vertexIdx) > 0;
+
+        return vertexIdx < vertexIsFracture_.size() && vertexIsFracture_[vertexIdx];
+    }
 
     /*!
      * \brief Returns true iff a fracture is associated with a given edge.
@@ -94,13 +151,34 @@ public:
      */
     bool isFractureEdge(unsigned vertex1Idx, unsigned vertex2Idx) const
     {
-        FractureEdge tmp(vertex1Idx, vertex2Idx);
-        return fractureEdges_.count(tmp) > 0;
+        if (!finalized_) {
+            FractureEdge tmp(vertex1Idx, vertex2Idx);
+            return fractureEdges_.count(tmp) > 0;
+        }
+
+        if (!isFractureVertex(vertex1Idx))
+            return false;
+
+        // vertices are only connected to a handful of fracture
+        // neighbors, so a linear search is the fastest option here
+        const unsigned* it = neighborIndices_.data() + neighborOffsets_[vertex1Idx];
+        const unsigned* endIt = neighborIndices_.data() + neighborOffsets_[vertex1Idx + 1];
+        for (; it != endIt && *it <= vertex2Idx; ++it)
+            if (*it == vertex2Idx)
+                return true;
+        return false;
     }
 
 private:
     std::set<FractureEdge> fractureEdges_;
     std::set<unsigned> fractureVertices_;
+
+    // flat representation of the fracture topology which is used
+    // after finalize() has been called
+    bool finalized_;
+    std::vector<unsigned char> vertexIsFracture_;
+    std::vector<unsigned> neighborOffsets_;
+    std::vector<unsigned> neighborIndices_;
 };
 
 } // namespace Opm
@@ -129,6 +129,23 @@ public:
     virtual void postSolve(GlobalEqVector& residual OPM_UNUSED)
     {};
 
+    /*!
+     * \brief Save the internal state of the module which is not part of the
+     *        solution vector.
+     *
+     * This is called by FvBaseDiscretization::createSnapshot(). By default,
+     * auxiliary modules do not exhibit any such state.
+     */
+    virtual void createSnapshot()
+    {}
+
+    /*!
+     * \brief Restore the internal state of the module saved by the last call of
+     *        createSnapshot().
+     */
+    virtual void restoreSnapshot()
+    {}
+
 private:
     int dofOffset_;
 };
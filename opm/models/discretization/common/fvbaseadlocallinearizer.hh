@@ -147,6 +147,10 @@ public:
         simulatorPtr_ = &simulator;
         delete internalElemContext_;
         internalElemContext_ = new ElementContext(simulator);
+
+        // allocate the memory for the largest stencil of the grid up front
+        size_t maxDof = simulator.model().maxStencilDofs();
+        residual_.reserve(maxDof);
     }
 
     /*!
@@ -47,11 +47,14 @@
 #include "fvbaseextensivequantities.hh"
 #include "baseauxiliarymodule.hh"
 
+#include <opm/models/nonlinear/timestepcontrollers.hh>
 #include <opm/models/parallel/gridcommhandles.hh>
 #include <opm/models/parallel/threadmanager.hh>
+#include <opm/models/parallel/reproduciblesum.hh>
 #include <opm/simulators/linalg/nullborderlistmanager.hh>
 #include <opm/models/utils/simulator.hh>
 #include <opm/models/utils/alignedallocator.hh>
+#include <opm/models/utils/reorderedmapper.hh>
 #include <opm/models/utils/timer.hh>
 #include <opm/models/utils/timerguard.hh>
 #include <opm/simulators/linalg/matrixblock.hh>
@@ -73,6 +76,8 @@
 #include <dune/fem/misc/capabilities.hh>
 #endif
 
+#include <algorithm>
+#include <deque>
 #include <limits>
 #include <list>
 #include <sstream>
@@ -92,11 +97,14 @@ SET_TYPE_PROP(FvBaseDiscretization, Simulator, Opm::Simulator<TypeTag>);
 
 //! Mapper for the grid view's vertices.
 SET_TYPE_PROP(FvBaseDiscretization, VertexMapper,
-              Dune::MultipleCodimMultipleGeomTypeMapper<typename GET_PROP_TYPE(TypeTag, GridView)>);
+              Opm::ReorderedMapper<typename GET_PROP_TYPE(TypeTag, GridView)>);
 
 //! Mapper for the grid view's elements.
 SET_TYPE_PROP(FvBaseDiscretization, ElementMapper,
-              Dune::MultipleCodimMultipleGeomTypeMapper<typename GET_PROP_TYPE(TypeTag, GridView)>);
+              Opm::ReorderedMapper<typename GET_PROP_TYPE(TypeTag, GridView)>);
+
+//! use the numbering of the grid's index set by default
+SET_STRING_PROP(FvBaseDiscretization, DofOrdering, "natural");
 
 //! marks the border indices (required for the algebraic overlap stuff)
 SET_PROP(FvBaseDiscretization, BorderListCreator)
@@ -125,6 +133,17 @@ SET_INT_PROP(FvBaseDiscretization, MaxTimeStepDivisions, 10);
 //! step size.
 SET_BOOL_PROP(FvBaseDiscretization, ContinueOnConvergenceError, false);
 
+//! By default, do not keep snapshots of the model's state for rolling back failed
+//! time steps
+SET_BOOL_PROP(FvBaseDiscretization, EnableTimeStepSnapshots, false);
+
+//! By default, the time step size is chosen based on the number of Newton iterations
+SET_TYPE_PROP(FvBaseDiscretization, TimeStepController, Opm::NewtonIterationTimeStepController<TypeTag>);
+
+//! The parameters of the PID and error estimate based time step controllers
+SET_SCALAR_PROP(FvBaseDiscretization, TimeStepControlTolerance, 0.1);
+SET_SCALAR_PROP(FvBaseDiscretization, TimeStepControlMaxGrowth, 3.0);
+
 /*!
  * \brief A vector of quanties, each for one equation.
  */
@@ -194,6 +213,24 @@ SET_TYPE_PROP(FvBaseDiscretization, ConstraintsContext, Opm::FvBaseConstraintsCo
 SET_TYPE_PROP(FvBaseDiscretization, ThreadManager, Opm::ThreadManager<TypeTag>);
 SET_INT_PROP(FvBaseDiscretization, ThreadsPerProcess, 1);
 SET_BOOL_PROP(FvBaseDiscretization, UseLinearizationLock, true);
+SET_BOOL_PROP(FvBaseDiscretization, UseColoredFiniteDifferences, false);
+
+//! assemble the full Jacobian matrix by default
+SET_BOOL_PROP(FvBaseDiscretization, EnableMatrixFreeLinearization, false);
+
+/*!
+ * \brief Specify which kind of method should be used to numerically
+ * calculate the partial derivatives of the residual.
+ *
+ * -1 means backward differences, 0 means central differences, 1 means
+ * forward differences. By default we use forward differences.
+ */
+SET_INT_PROP(FvBaseDiscretization, NumericDifferenceMethod, +1);
+
+//! The base epsilon value for finite difference calculations
+SET_SCALAR_PROP(FvBaseDiscretization,
+                BaseEpsilon,
+                std::max<Scalar>(0.9123e-10, std::numeric_limits<Scalar>::epsilon()*1.23e3));
 
 /*!
  * \brief Linearizer for the global system of equations.
@@ -223,9 +260,15 @@ SET_BOOL_PROP(FvBaseDiscretization, EnableAsyncVtkOutput, true);
 //! Set the format of the VTK output to ASCII by default
 SET_INT_PROP(FvBaseDiscretization, VtkOutputFormat, Dune::VTK::ascii);
 
+//! Do not compress the VTK output by default
+SET_BOOL_PROP(FvBaseDiscretization, EnableVtkCompression, false);
+
 // disable caching the storage term by default
 SET_BOOL_PROP(FvBaseDiscretization, EnableStorageCache, false);
 
+// use the faster, but not reproducible, summation by default
+SET_BOOL_PROP(FvBaseDiscretization, EnableReproducibleSums, false);
+
 // disable constraints by default
 SET_BOOL_PROP(FvBaseDiscretization, EnableConstraints, false);
 
@@ -239,6 +282,9 @@ SET_BOOL_PROP(FvBaseDiscretization, EnableIntensiveQuantityCache, false);
 // enable the intensive quantity cache above to avoid getting an exception...
 SET_BOOL_PROP(FvBaseDiscretization, EnableThermodynamicHints, false);
 
+// start the Newton method at the solution of the previous time step by default
+SET_INT_PROP(FvBaseDiscretization, SolutionExtrapolationOrder, 0);
+
 // if the deflection of the newton method is large, we do not need to solve the linear
 // approximation accurately. Assuming that the value for the current solution is quite
 // close to the final value, a reduction of 3 orders of magnitude in the defect should be
@@ -310,7 +356,10 @@ class FvBaseDiscretization
         historySize = GET_PROP_VALUE(TypeTag, TimeDiscHistorySize),
     };
 
-    typedef std::vector<IntensiveQuantities, Opm::aligned_allocator<IntensiveQuantities, alignof(IntensiveQuantities)> > IntensiveQuantitiesVector;
+    // the caches are accessed by all threads during the linearization, so their pages
+    // are distributed over the NUMA nodes of the threads
+    typedef std::vector<IntensiveQuantities, Opm::first_touch_allocator<IntensiveQuantities, alignof(IntensiveQuantities)> > IntensiveQuantitiesVector;
+    typedef Dune::BlockVector<EqVector, Opm::first_touch_allocator<EqVector, alignof(EqVector)> > StorageCacheVector;
 
     typedef typename GridView::template Codim<0>::Entity Element;
     typedef typename GridView::template Codim<0>::Iterator ElementIterator;
@@ -321,6 +370,20 @@ class FvBaseDiscretization
 
     typedef typename LocalResidual::LocalEvalBlockVector LocalEvalBlockVector;
 
+    // an in-memory copy of the state of the model, see createSnapshot()
+    struct Snapshot
+    {
+        Snapshot()
+            : valid(false)
+        {}
+
+        bool valid;
+        SolutionVector solution;
+        IntensiveQuantitiesVector intensiveQuantities;
+        std::vector<bool> intensiveQuantitiesUpToDate;
+        StorageCacheVector storage[historySize];
+    };
+
     class BlockVectorWrapper
     {
     protected:
@@ -366,8 +429,10 @@ public:
     FvBaseDiscretization(Simulator& simulator)
         : simulator_(simulator)
         , gridView_(simulator.gridView())
-        , elementMapper_(gridView_, Dune::mcmgElementLayout())
-        , vertexMapper_(gridView_, Dune::mcmgVertexLayout())
+        , elementMapper_(gridView_, Dune::mcmgElementLayout(),
+                         simulator.vanguard().elementPermutation())
+        , vertexMapper_(gridView_, Dune::mcmgVertexLayout(),
+                        simulator.vanguard().vertexPermutation())
         , newtonMethod_(simulator)
         , localLinearizer_(ThreadManager::maxThreads())
         , linearizer_(new Linearizer())
@@ -380,11 +445,18 @@ public:
         , enableIntensiveQuantityCache_(EWOMS_GET_PARAM(TypeTag, bool, EnableIntensiveQuantityCache))
         , enableStorageCache_(EWOMS_GET_PARAM(TypeTag, bool, EnableStorageCache))
         , enableThermodynamicHints_(EWOMS_GET_PARAM(TypeTag, bool, EnableThermodynamicHints))
+        , enableReproducibleSums_(EWOMS_GET_PARAM(TypeTag, bool, EnableReproducibleSums))
+        , extrapolationOrder_(EWOMS_GET_PARAM(TypeTag, unsigned, SolutionExtrapolationOrder))
     {
 #if HAVE_DUNE_FEM
         if (enableGridAdaptation_ && !Dune::Fem::Capabilities::isLocallyAdaptive<Grid>::v)
             throw std::invalid_argument("Grid adaptation enabled, but chosen Grid is not capable"
                                         " of adaptivity");
+
+        // the solution vectors use the numbering of the dune-fem discrete function space
+        if (asImp_().dofMapper().isReordered())
+            throw std::invalid_argument("The degrees of freedom cannot be reordered if the "
+                                        "dune-fem module is used");
 #else
         if (enableGridAdaptation_)
             throw std::invalid_argument("Grid adaptation currently requires the presence of the "
@@ -398,6 +470,14 @@ public:
 
         enableStorageCache_ = EWOMS_GET_PARAM(TypeTag, bool, EnableStorageCache);
 
+        if (extrapolationOrder_ > 2)
+            throw std::invalid_argument("The solution can only be extrapolated linearly or "
+                                        "quadratically (requested order: "
+                                        +std::to_string(extrapolationOrder_)+")");
+
+        maxStencilDofs_ = 0;
+        maxStencilInteriorFaces_ = 0;
+
         size_t numDof = asImp_().numGridDof();
         for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx) {
             solution_[timeIdx].reset(new DiscreteFunction("solution", space_));
@@ -447,6 +527,16 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableThermodynamicHints, "Enable thermodynamic hints");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableIntensiveQuantityCache, "Turn on caching of intensive quantities");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableStorageCache, "Store previous storage terms and avoid re-calculating them.");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableReproducibleSums,
+                             "Compute global sums and assemble the linear system such that "
+                             "the results do not depend on the number of threads");
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, DofOrdering,
+                             "The ordering of the degrees of freedom. Possible values: "
+                             "'natural', 'rcm' and 'hilbert'");
+        EWOMS_REGISTER_PARAM(TypeTag, unsigned, SolutionExtrapolationOrder,
+                             "The order of the polynomial used to extrapolate the initial guess "
+                             "of the Newton method from the previous solutions (0: disabled, "
+                             "1: linear, 2: quadratic)");
         EWOMS_REGISTER_PARAM(TypeTag, std::string, OutputDir, "The directory to which result files are written");
     }
 
@@ -462,6 +552,8 @@ public:
 
         ElementContext elemCtx(simulator_);
         gridTotalVolume_ = 0.0;
+        maxStencilDofs_ = 0;
+        maxStencilInteriorFaces_ = 0;
 
         // iterate through the grid and evaluate the initial condition
         ElementIterator elemIt = gridView_.template begin</*codim=*/0>();
@@ -478,6 +570,10 @@ public:
             elemCtx.updateStencil(elem);
             const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
 
+            maxStencilDofs_ = std::max<size_t>(maxStencilDofs_, stencil.numDof());
+            maxStencilInteriorFaces_ =
+                std::max<size_t>(maxStencilInteriorFaces_, stencil.numInteriorFaces());
+
             // loop over all element vertices, i.e. sub control volumes
             for (unsigned dofIdx = 0; dofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0); dofIdx++) {
                 // map the local degree of freedom index to the global one
@@ -867,6 +963,9 @@ public:
     {
         storage = 0;
 
+        // the partial sums for the reproducible summation (only used if it is enabled)
+        std::vector<ReproducibleSum> reproducibleStorage(enableReproducibleSums_ ? numEq : 0);
+
         std::mutex mutex;
         ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView());
 #ifdef _OPENMP
@@ -879,6 +978,8 @@ public:
             ElementContext elemCtx(simulator_);
             ElementIterator elemIt = threadedElemIt.beginParallel();
             LocalEvalBlockVector elemStorage;
+            elemStorage.reserve(maxStencilDofs_);
+            std::vector<ReproducibleSum> threadStorage(reproducibleStorage.size());
 
             // in this method, we need to disable the storage cache because we want to
             // evaluate the storage term for other time indices than the most recent one
@@ -897,15 +998,36 @@ public:
 
                 localResidual(threadId).evalStorage(elemStorage, elemCtx, timeIdx);
 
+                if (enableReproducibleSums_) {
+                    // the result of the reproducible summation does not depend on the
+                    // order of the summands, so each thread can sum up on its own
+                    for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx)
+                        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                            threadStorage[eqIdx] += Toolbox::value(elemStorage[dofIdx][eqIdx]);
+                    continue;
+                }
+
                 mutex.lock();
                 for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx)
                     for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
                         storage[eqIdx] += Toolbox::value(elemStorage[dofIdx][eqIdx]);
                 mutex.unlock();
             }
+
+            if (enableReproducibleSums_) {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    reproducibleStorage[eqIdx].merge(threadStorage[eqIdx]);
+            }
         }
 
-        storage = gridView_.comm().sum(storage);
+        if (enableReproducibleSums_) {
+            ReproducibleSum::sumOverProcesses(reproducibleStorage.data(), numEq, gridView_.comm());
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                storage[eqIdx] = reproducibleStorage[eqIdx].value();
+        }
+        else
+            storage = gridView_.comm().sum(storage);
     }
 
     /*!
@@ -1051,6 +1173,24 @@ public:
     Scalar gridTotalVolume() const
     { return gridTotalVolume_; }
 
+    /*!
+     * \brief Returns the largest number of degrees of freedom of the stencil of any
+     *        interior element of the local grid partition.
+     *
+     * This is used by the per-thread element contexts and local linearizers to
+     * allocate their memory up front, so that they do not need to allocate memory
+     * while they are moved from element to element during the linearization.
+     */
+    size_t maxStencilDofs() const
+    { return maxStencilDofs_; }
+
+    /*!
+     * \brief Returns the largest number of interior faces of the stencil of any
+     *        interior element of the local grid partition.
+     */
+    size_t maxStencilInteriorFaces() const
+    { return maxStencilInteriorFaces_; }
+
     /*!
      * \brief Reference to the solution at a given history index as a block vector.
      *
@@ -1127,6 +1267,25 @@ public:
         return 1.0/std::max(absPv, 1.0);
     }
 
+    /*!
+     * \brief Returns the perturbation of a primary variable which is used to calculate
+     *        partial derivatives using finite differences.
+     *
+     * This is the value of the BaseEpsilon property divided by the weight of the
+     * primary variable.
+     *
+     * \param globalDofIdx The global index of the degree of freedom
+     * \param pvIdx The index of the primary variable
+     */
+    Scalar numericDifferenceEpsilon(unsigned globalDofIdx, unsigned pvIdx) const
+    {
+        Scalar pvWeight = asImp_().primaryVarWeight(globalDofIdx, pvIdx);
+        assert(pvWeight > 0 && std::isfinite(pvWeight));
+        Opm::Valgrind::CheckDefined(pvWeight);
+
+        return GET_PROP_VALUE(TypeTag, BaseEpsilon)/pvWeight;
+    }
+
     /*!
      * \brief Returns the relative weight of an equation
      *
@@ -1188,6 +1347,7 @@ public:
         updateTimer_.halt();
 
         prePostProcessTimer_.start();
+        extrapolateSolution_();
         asImp_().updateBegin();
         prePostProcessTimer_.stop();
 
@@ -1267,6 +1427,107 @@ public:
     void updateSuccessful()
     { }
 
+    /*!
+     * \brief Save the current state of the model in memory.
+     *
+     * The snapshot consists of the current solution, the intensive quantities and
+     * storage terms cached for it and the state of the auxiliary modules. It can be
+     * restored cheaply using restoreSnapshot(), e.g. to retry a failed time step
+     * without re-calculating the cached quantities. If a snapshot is available, the
+     * model is rolled back to it automatically if an update fails. The snapshot is
+     * only valid for the current time step, i.e., it gets invalidated when the model
+     * advances to the next time level.
+     */
+    void createSnapshot()
+    {
+        snapshot_.solution = solution(/*timeIdx=*/0);
+
+        if (storeIntensiveQuantities()) {
+            snapshot_.intensiveQuantities = intensiveQuantityCache_[/*timeIdx=*/0];
+            snapshot_.intensiveQuantitiesUpToDate = intensiveQuantityCacheUpToDate_[/*timeIdx=*/0];
+        }
+
+        if (enableStorageCache_)
+            for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx)
+                snapshot_.storage[timeIdx] = storageCache_[timeIdx];
+
+        for (auto* auxMod : auxEqModules_)
+            auxMod->createSnapshot();
+
+        snapshot_.valid = true;
+    }
+
+    /*!
+     * \brief Returns true if a snapshot of the model's state is available.
+     */
+    bool haveSnapshot() const
+    { return snapshot_.valid; }
+
+    /*!
+     * \brief Roll the model back to the state saved by the last call of
+     *        createSnapshot().
+     *
+     * The snapshot stays available, i.e., it can be restored multiple times.
+     */
+    void restoreSnapshot()
+    {
+        if (!snapshot_.valid)
+            throw std::logic_error("No snapshot of the model's state is available");
+        if (snapshot_.solution.size() != solution(/*timeIdx=*/0).size())
+            throw std::logic_error("The snapshot of the model's state does not match the grid");
+
+        solution(/*timeIdx=*/0) = snapshot_.solution;
+
+        if (storeIntensiveQuantities()) {
+            intensiveQuantityCache_[/*timeIdx=*/0] = snapshot_.intensiveQuantities;
+            intensiveQuantityCacheUpToDate_[/*timeIdx=*/0] = snapshot_.intensiveQuantitiesUpToDate;
+        }
+
+        if (enableStorageCache_)
+            for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx)
+                storageCache_[timeIdx] = snapshot_.storage[timeIdx];
+
+        for (auto* auxMod : auxEqModules_)
+            auxMod->restoreSnapshot();
+    }
+
+    /*!
+     * \brief Discard the snapshot of the model's state.
+     */
+    void discardSnapshot()
+    { snapshot_ = Snapshot(); }
+
+    /*!
+     * \brief Returns the order of the polynomial which is used to extrapolate the
+     *        initial guess of the Newton method (0 if extrapolation is disabled).
+     */
+    unsigned solutionExtrapolationOrder() const
+    { return extrapolationOrder_; }
+
+    /*!
+     * \brief Returns true if the primary variables of a degree of freedom at two
+     *        different points in time can be used to extrapolate the solution.
+     *
+     * Models whose primary variables can change their meaning (e.g. because of
+     * phase switches) need to overload this method.
+     */
+    bool primaryVarsExtrapolable(const PrimaryVariables& priVars1 OPM_UNUSED,
+                                 const PrimaryVariables& priVars2 OPM_UNUSED) const
+    { return true; }
+
+    /*!
+     * \brief Restrict the extrapolated primary variables of a degree of freedom to
+     *        their physically meaningful range.
+     *
+     * By default, this method does nothing.
+     *
+     * \param priVars The extrapolated primary variables
+     * \param oldPriVars The primary variables before the extrapolation
+     */
+    void limitExtrapolatedPrimaryVars(PrimaryVariables& priVars OPM_UNUSED,
+                                      const PrimaryVariables& oldPriVars OPM_UNUSED) const
+    { }
+
     /*!
      * \brief Called by the update() method when the grid should be refined.
      */
@@ -1289,6 +1550,11 @@ public:
                 vertexMapper_.update();
                 resetLinearizer();
 
+                // the solutions of the previous time steps do not fit the new grid
+                extrapolationHistory_.clear();
+                extrapolationStepSizes_.clear();
+                discardSnapshot();
+
                 // this is a bit hacky because it supposes that Problem::finishInit()
                 // works fine multiple times in a row.
                 //
@@ -1315,14 +1581,23 @@ public:
      * \brief Called by the update() method if it was
      *        unsuccessful. This is primary a hook which the actual
      *        model can overload.
+     *
+     * If a snapshot of the model's state is available, the model is rolled back to it.
      */
     void updateFailed()
     {
-        // Reset the current solution to the one of the
-        // previous time step so that we can start the next
-        // update at a physically meaningful solution.
-        solution(/*timeIdx=*/0) = solution(/*timeIdx=*/1);
-        invalidateIntensiveQuantitiesCache(/*timeIdx=*/0);
+        if (haveSnapshot())
+            // roll back to the beginning of the time step. in contrast to the code
+            // below, this keeps the cached quantities, so they do not need to be
+            // re-calculated by the next attempt.
+            asImp_().restoreSnapshot();
+        else {
+            // Reset the current solution to the one of the
+            // previous time step so that we can start the next
+            // update at a physically meaningful solution.
+            solution(/*timeIdx=*/0) = solution(/*timeIdx=*/1);
+            invalidateIntensiveQuantitiesCache(/*timeIdx=*/0);
+        }
 
 #ifndef NDEBUG
         for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx) {
@@ -1347,12 +1622,28 @@ public:
         // at this point we can adapt the grid
         asImp_().adaptGrid();
 
+        // remember the solution at the beginning of the time step which has just been
+        // completed to extrapolate the initial guess of the next one
+        if (extrapolationOrder_ > 0) {
+            extrapolationHistory_.push_front(solution(/*timeIdx=*/1));
+            extrapolationStepSizes_.push_front(simulator_.timeStepSize());
+            while (extrapolationHistory_.size() > extrapolationOrder_) {
+                extrapolationHistory_.pop_back();
+                extrapolationStepSizes_.pop_back();
+            }
+        }
+
         // make the current solution the previous one.
         solution(/*timeIdx=*/1) = solution(/*timeIdx=*/0);
 
         // shift the intensive quantities cache by one position in the
         // history
         asImp_().shiftIntensiveQuantityCache(/*numSlots=*/1);
+
+        // the snapshot refers to the beginning of the time step which has just been
+        // completed. its buffers are kept so that the next snapshot does not need to
+        // allocate them again.
+        snapshot_.valid = false;
     }
 
     /*!
@@ -1569,11 +1860,13 @@ public:
         Scalar minRelErr = 1e30;
         Scalar maxRelErr = -1e30;
         for (unsigned globalIdx = 0; globalIdx < numGridDof; ++ globalIdx) {
+            // the writer expects the data in the order of the grid's index set
+            unsigned outIdx = static_cast<unsigned>(asImp_().dofMapper().naturalIndex(globalIdx));
             for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx) {
-                (*priVars[pvIdx])[globalIdx] = u[globalIdx][pvIdx];
-                (*priVarWeight[pvIdx])[globalIdx] = asImp_().primaryVarWeight(globalIdx, pvIdx);
-                (*delta[pvIdx])[globalIdx] = - deltaU[globalIdx][pvIdx];
-                (*def[pvIdx])[globalIdx] = globalResid[globalIdx][pvIdx];
+                (*priVars[pvIdx])[outIdx] = u[globalIdx][pvIdx];
+                (*priVarWeight[pvIdx])[outIdx] = asImp_().primaryVarWeight(globalIdx, pvIdx);
+                (*delta[pvIdx])[outIdx] = - deltaU[globalIdx][pvIdx];
+                (*def[pvIdx])[outIdx] = globalResid[globalIdx][pvIdx];
             }
 
             PrimaryVariables uOld(u[globalIdx]);
@@ -1581,8 +1874,8 @@ public:
             uNew -= deltaU[globalIdx];
 
             Scalar err = asImp_().relativeDofError(globalIdx, uOld, uNew);
-            (*relError)[globalIdx] = err;
-            (*normalizedRelError)[globalIdx] = err;
+            (*relError)[outIdx] = err;
+            (*normalizedRelError)[outIdx] = err;
             minRelErr = std::min(err, minRelErr);
             maxRelErr = std::max(err, maxRelErr);
         }
@@ -1783,6 +2076,25 @@ public:
     { return updateTimer_; }
 
 protected:
+    /*!
+     * \brief Return the intensive quantities which are stored for an entity on the grid
+     *        for the most recent solution.
+     *
+     * In contrast to cachedIntensiveQuantities(), this also considers intensive
+     * quantities which are only stored because thermodynamic hints are enabled. If no
+     * up-to date intensive quantities are stored, this method returns 0.
+     *
+     * \param globalIdx The global space index for the entity
+     */
+    const IntensiveQuantities* storedIntensiveQuantities_(unsigned globalIdx) const
+    {
+        if (!storeIntensiveQuantities() ||
+            !intensiveQuantityCacheUpToDate_[/*timeIdx=*/0][globalIdx])
+            return 0;
+
+        return &intensiveQuantityCache_[/*timeIdx=*/0][globalIdx];
+    }
+
     void resizeAndResetIntensiveQuantitiesCache_()
     {
         // allocate the storage cache
@@ -1836,6 +2148,62 @@ protected:
     bool verbose_() const
     { return gridView_.comm().rank() == 0; }
 
+    // extrapolate the initial guess of the Newton method from the solutions of the
+    // previous time steps
+    void extrapolateSolution_()
+    {
+        unsigned order = std::min<unsigned>(extrapolationOrder_,
+                                            static_cast<unsigned>(extrapolationHistory_.size()));
+        if (order == 0)
+            return;
+
+        SolutionVector& uCur = solution(/*timeIdx=*/0);
+        for (unsigned histIdx = 0; histIdx < order; ++histIdx)
+            if (extrapolationHistory_[histIdx].size() != uCur.size())
+                return;
+
+        // the points in time of the solutions relative to the beginning of the time
+        // step and the weights of the Lagrange polynomial at the end of the time step
+        Scalar t[3] = { 0.0, 0.0, 0.0 };
+        for (unsigned histIdx = 0; histIdx < order; ++histIdx)
+            t[histIdx + 1] = t[histIdx] - extrapolationStepSizes_[histIdx];
+
+        Scalar tEnd = simulator_.timeStepSize();
+        Scalar w[3];
+        for (unsigned i = 0; i <= order; ++i) {
+            w[i] = 1.0;
+            for (unsigned j = 0; j <= order; ++j)
+                if (i != j)
+                    w[i] *= (tEnd - t[j])/(t[i] - t[j]);
+        }
+
+        // the auxiliary modules are not extrapolated
+        size_t numGridDof = asImp_().numGridDof();
+        for (size_t dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
+            const PrimaryVariables& oldPriVars = uCur[dofIdx];
+
+            bool extrapolable = true;
+            for (unsigned histIdx = 0; histIdx < order && extrapolable; ++histIdx)
+                extrapolable = asImp_().primaryVarsExtrapolable(oldPriVars,
+                                                                extrapolationHistory_[histIdx][dofIdx]);
+            if (!extrapolable)
+                continue;
+
+            PrimaryVariables priVars(oldPriVars);
+            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx) {
+                Scalar value = w[0]*oldPriVars[pvIdx];
+                for (unsigned histIdx = 0; histIdx < order; ++histIdx)
+                    value += w[histIdx + 1]*extrapolationHistory_[histIdx][dofIdx][pvIdx];
+                priVars[pvIdx] = value;
+            }
+
+            asImp_().limitExtrapolatedPrimaryVars(priVars, oldPriVars);
+            uCur[dofIdx] = priVars;
+        }
+
+        invalidateIntensiveQuantitiesCache(/*timeIdx=*/0);
+    }
+
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
     const Implementation& asImp_() const
@@ -1885,15 +2253,26 @@ protected:
     std::list<BaseOutputModule<TypeTag>*> outputModules_;
 
     Scalar gridTotalVolume_;
+    size_t maxStencilDofs_;
+    size_t maxStencilInteriorFaces_;
     std::vector<Scalar> dofTotalVolume_;
     std::vector<bool> isLocalDof_;
 
-    mutable GlobalEqVector storageCache_[historySize];
+    mutable StorageCacheVector storageCache_[historySize];
 
     bool enableGridAdaptation_;
     bool enableIntensiveQuantityCache_;
     bool enableStorageCache_;
     bool enableThermodynamicHints_;
+    bool enableReproducibleSums_;
+
+    // the solutions at the beginning of the previous time steps (most recent first)
+    // and the sizes of the time steps which started at them
+    unsigned extrapolationOrder_;
+    std::deque<SolutionVector> extrapolationHistory_;
+    std::deque<Scalar> extrapolationStepSizes_;
+
+    Snapshot snapshot_;
 };
 } // namespace Opm
 
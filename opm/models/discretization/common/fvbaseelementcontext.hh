@@ -100,6 +100,11 @@ public:
         enableStorageCache_ = EWOMS_GET_PARAM(TypeTag, bool, EnableStorageCache);
         stashedDofIdx_ = -1;
         focusDofIdx_ = -1;
+
+        // allocate the memory for the largest stencil of the grid, so that moving the
+        // context from element to element does not need to allocate any memory
+        dofVars_.reserve(simulator.model().maxStencilDofs());
+        extensiveQuantities_.reserve(simulator.model().maxStencilInteriorFaces());
     }
 
     static void *operator new(size_t size)
@@ -77,20 +77,6 @@ SET_TYPE_PROP(FiniteDifferenceLocalLinearizer, LocalLinearizer,
 SET_TYPE_PROP(FiniteDifferenceLocalLinearizer, Evaluation,
               typename GET_PROP_TYPE(TypeTag, Scalar));
 
-/*!
- * \brief Specify which kind of method should be used to numerically
- * calculate the partial derivatives of the residual.
- *
- * -1 means backward differences, 0 means central differences, 1 means
- * forward differences. By default we use central differences.
- */
-SET_INT_PROP(FiniteDifferenceLocalLinearizer, NumericDifferenceMethod, +1);
-
-//! The base epsilon value for finite difference calculations
-SET_SCALAR_PROP(FiniteDifferenceLocalLinearizer,
-                BaseEpsilon,
-                std::max<Scalar>(0.9123e-10, std::numeric_limits<Scalar>::epsilon()*1.23e3));
-
 END_PROPERTIES
 
 namespace Opm {
@@ -182,11 +168,7 @@ public:
      * \brief Register all run-time parameters for the local jacobian.
      */
     static void registerParameters()
-    {
-        EWOMS_REGISTER_PARAM(TypeTag, int, NumericDifferenceMethod,
-                             "The method used for numeric differentiation (-1: backward "
-                             "differences, 0: central differences, 1: forward differences)");
-    }
+    { }
 
     /*!
      * \brief Initialize the local Jacobian object.
@@ -201,6 +183,11 @@ public:
         simulatorPtr_ = &simulator;
         delete internalElemContext_;
         internalElemContext_ = new ElementContext(simulator);
+
+        // allocate the memory for the largest stencil of the grid up front
+        size_t maxDof = simulator.model().maxStencilDofs();
+        residual_.reserve(maxDof);
+        derivResidual_.reserve(maxDof);
     }
 
     /*!
@@ -281,11 +268,7 @@ public:
                           unsigned pvIdx) const
     {
         unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
-        Scalar pvWeight = elemCtx.model().primaryVarWeight(globalIdx, pvIdx);
-        assert(pvWeight > 0 && std::isfinite(pvWeight));
-        Opm::Valgrind::CheckDefined(pvWeight);
-
-        return baseEpsilon()/pvWeight;
+        return elemCtx.model().numericDifferenceEpsilon(globalIdx, pvIdx);
     }
 
     /*!
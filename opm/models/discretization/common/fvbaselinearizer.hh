@@ -34,6 +34,8 @@
 #include <opm/models/parallel/threadmanager.hh>
 #include <opm/models/parallel/threadedentityiterator.hh>
 #include <opm/models/discretization/common/baseauxiliarymodule.hh>
+#include <opm/models/utils/genericguard.hh>
+#include <opm/models/utils/parametersystem.hh>
 
 #include <opm/material/common/Exceptions.hpp>
 
@@ -41,12 +43,17 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <algorithm>
 #include <type_traits>
 #include <iostream>
+#include <limits>
+#include <cmath>
+#include <cassert>
 #include <vector>
 #include <thread>
 #include <set>
 #include <exception>   // current_exception, rethrow_exception
+#include <stdexcept>
 #include <mutex>
 
 namespace Opm {
@@ -92,6 +99,7 @@ class FvBaseLinearizer
 
     typedef typename GridView::template Codim<0>::Entity Element;
     typedef typename GridView::template Codim<0>::Iterator ElementIterator;
+    typedef typename Element::EntitySeed ElementSeed;
 
     typedef GlobalEqVector Vector;
 
@@ -104,6 +112,7 @@ class FvBaseLinearizer
     typedef Dune::FieldVector<Scalar, numEq> VectorBlock;
 
     static const bool linearizeNonLocalElements = GET_PROP_VALUE(TypeTag, LinearizeNonLocalElements);
+    static const bool matrixFreeLinearization = GET_PROP_VALUE(TypeTag, EnableMatrixFreeLinearization);
 
     // copying the linearizer is not a good idea
     FvBaseLinearizer(const FvBaseLinearizer&);
@@ -114,6 +123,9 @@ public:
         : jacobian_()
     {
         simulatorPtr_ = 0;
+        useColoredFiniteDifferences_ = false;
+        updatePvWeights_ = false;
+        reproducibleAssembly_ = false;
     }
 
     ~FvBaseLinearizer()
@@ -128,7 +140,15 @@ public:
      * \brief Register all run-time parameters for the Jacobian linearizer.
      */
     static void registerParameters()
-    { }
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, bool, UseColoredFiniteDifferences,
+                             "Linearize the domain using finite differences of the global "
+                             "residual for groups of structurally independent degrees of "
+                             "freedom instead of using the local linearizer");
+        EWOMS_REGISTER_PARAM(TypeTag, int, NumericDifferenceMethod,
+                             "The method used for numeric differentiation (-1: backward "
+                             "differences, 0: central differences, 1: forward differences)");
+    }
 
     /*!
      * \brief Initialize the linearizer.
@@ -142,6 +162,12 @@ public:
     void init(Simulator& simulator)
     {
         simulatorPtr_ = &simulator;
+        useColoredFiniteDifferences_ = EWOMS_GET_PARAM(TypeTag, bool, UseColoredFiniteDifferences);
+        reproducibleAssembly_ = EWOMS_GET_PARAM(TypeTag, bool, EnableReproducibleSums);
+        if (matrixFreeLinearization && useColoredFiniteDifferences_)
+            throw std::logic_error("Colored finite differences require the full Jacobian "
+                                   "matrix, so they cannot be used for matrix-free "
+                                   "linearizations");
         eraseMatrix();
     }
 
@@ -211,6 +237,100 @@ public:
             throw Opm::NumericalIssue("A process did not succeed in linearizing the system");
     }
 
+    /*!
+     * \brief Evaluate the residual of the spatial domain without linearizing it.
+     *
+     * In contrast to linearizeDomain(), the local residual is evaluated only once per
+     * element, no partial derivatives are extracted and the Jacobian matrix is left
+     * untouched. This is useful if only the residual is required, e.g., to determine
+     * the error after an update of the solution. The auxiliary equations are not
+     * considered, so their entries of the residual are zero.
+     *
+     * Note that the intensive quantities and the local residual are still evaluated
+     * using the Evaluation type of the model, i.e., with automatic differentiation if
+     * the model uses it. Compared to linearizeDomain(), this only saves the extraction
+     * of the derivatives, the assembly of the Jacobian matrix and, for discretizations
+     * with several primary degrees of freedom per element, the repeated evaluation of
+     * the local residual for each of them.
+     *
+     * If the storage term is cached, the storage cache for the beginning of the time
+     * step must have been populated before this method is called, i.e., the domain
+     * must have been linearized at least once for the current time step.
+     */
+    void linearizeResidualOnly()
+    {
+        if (!jacobian_)
+            initFirstIteration_();
+
+        int succeeded;
+        try {
+            linearizeResidualOnly_();
+            succeeded = 1;
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while evaluating the residual:" << e.what()
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        catch (...)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while evaluating the residual"
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        succeeded = gridView_().comm().min(succeeded);
+
+        if (!succeeded)
+            throw Opm::NumericalIssue("A process did not succeed in evaluating the residual");
+    }
+
+    /*!
+     * \brief Multiply the Jacobian matrix of the spatial domain with a vector without
+     *        using the assembled matrix.
+     *
+     * The local linearizer is called for each element and its local Jacobian matrix is
+     * directly multiplied with the respective entries of the vector. This costs about
+     * as much as linearizing the domain, but it does not need the global Jacobian
+     * matrix, i.e., it can be used if the EnableMatrixFreeLinearization property is
+     * set. The rows of constraint degrees of freedom are the identity and the auxiliary
+     * equations are not considered.
+     *
+     * The domain must have been linearized for the current solution before this method
+     * is called.
+     *
+     * \param x The vector which is multiplied with the Jacobian matrix
+     * \param y The vector which receives the result
+     */
+    void applyJacobian(const GlobalEqVector& x, GlobalEqVector& y)
+    {
+        int succeeded;
+        try {
+            applyJacobian_(x, y);
+            succeeded = 1;
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while applying the Jacobian:" << e.what()
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        catch (...)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while applying the Jacobian"
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        succeeded = gridView_().comm().min(succeeded);
+
+        if (!succeeded)
+            throw Opm::NumericalIssue("A process did not succeed in applying the Jacobian");
+    }
+
     void finalize()
     { jacobian_->finalize(); }
 
@@ -322,33 +442,156 @@ private:
         typedef std::set< unsigned > NeighborSet;
         std::vector<NeighborSet> sparsityPattern(model.numTotalDof());
 
+        if (matrixFreeLinearization) {
+            // the linear solver only uses the diagonal blocks of the Jacobian matrix
+            if (model.numAuxiliaryModules() > 0)
+                throw std::logic_error("Matrix-free linearizations do not support "
+                                       "auxiliary equations");
+
+            for (unsigned dofIdx = 0; dofIdx < sparsityPattern.size(); ++dofIdx)
+                sparsityPattern[dofIdx].insert(dofIdx);
+        }
+        else {
+            ElementIterator elemIt = gridView_().template begin<0>();
+            const ElementIterator elemEndIt = gridView_().template end<0>();
+            for (; elemIt != elemEndIt; ++elemIt) {
+                const Element& elem = *elemIt;
+                stencil.update(elem);
+
+                for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
+                    unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
+
+                    for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
+                        unsigned neighborIdx = stencil.globalSpaceIndex(dofIdx);
+                        sparsityPattern[myIdx].insert(neighborIdx);
+                    }
+                }
+            }
+
+            // add the additional neighbors and degrees of freedom caused by the auxiliary
+            // equations
+            size_t numAuxMod = model.numAuxiliaryModules();
+            for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
+                model.auxiliaryModule(auxModIdx)->addNeighbors(sparsityPattern);
+        }
+
+        // allocate raw matrix
+        jacobian_.reset(new SparseMatrixAdapter(simulator_()));
+
+        // create matrix structure based on sparsity pattern
+        jacobian_->reserve(sparsityPattern);
+
+        if (useColoredFiniteDifferences_)
+            computeColoring_(sparsityPattern);
+
+        if (reproducibleAssembly_)
+            computeElementColoring_();
+    }
+
+    // partition the elements which need to be linearized into groups which do not share
+    // any primary degree of freedom. the elements of a group write to disjoint entries
+    // of the residual and of the Jacobian matrix, so they can be linearized concurrently
+    // without affecting the result. since the groups are processed one after another,
+    // the contributions of the elements to each entry are always summed up in the same
+    // order, regardless of the number of threads. for cell centered discretizations,
+    // there is only a single group.
+    void computeElementColoring_()
+    {
+        static const unsigned noColor = std::numeric_limits<unsigned>::max();
+
+        Stencil stencil(gridView_(), dofMapper_());
+        std::vector<std::vector<unsigned> > dofColors(model_().numGridDof());
+
+        // colorUsedBy[colorIdx] is the index of the last element for which the color
+        // was found to be unavailable
+        std::vector<unsigned> colorUsedBy;
+        elementColorSeeds_.clear();
+
+        unsigned elemIdx = 0;
         ElementIterator elemIt = gridView_().template begin<0>();
         const ElementIterator elemEndIt = gridView_().template end<0>();
         for (; elemIt != elemEndIt; ++elemIt) {
             const Element& elem = *elemIt;
+            if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
+                continue;
+
             stencil.update(elem);
+            unsigned numPrimaryDof = stencil.numPrimaryDof();
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++primaryDofIdx)
+                for (unsigned otherColor : dofColors[stencil.globalSpaceIndex(primaryDofIdx)])
+                    colorUsedBy[otherColor] = elemIdx;
+
+            unsigned colorIdx = 0;
+            while (colorIdx < colorUsedBy.size() && colorUsedBy[colorIdx] == elemIdx)
+                ++colorIdx;
+            if (colorIdx == colorUsedBy.size()) {
+                colorUsedBy.push_back(noColor);
+                elementColorSeeds_.emplace_back();
+            }
 
-            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
-                unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++primaryDofIdx)
+                dofColors[stencil.globalSpaceIndex(primaryDofIdx)].push_back(colorIdx);
+            elementColorSeeds_[colorIdx].push_back(elem.seed());
 
-                for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
-                    unsigned neighborIdx = stencil.globalSpaceIndex(dofIdx);
-                    sparsityPattern[myIdx].insert(neighborIdx);
-                }
+            ++elemIdx;
+        }
+    }
+
+    // partition the degrees of freedom into groups which can be perturbed
+    // simultaneously, i.e., no row of the Jacobian matrix exhibits a non-zero entry for
+    // more than one degree of freedom of each group. (this is a greedy distance-2
+    // coloring of the sparsity pattern, see A.R. Curtis, M.J.D. Powell, J.K. Reid: "On
+    // the estimation of sparse Jacobian matrices", IMA Journal of Applied Mathematics,
+    // 13, pp. 117-119, 1974)
+    //
+    // only the degrees of freedom of the grid are considered because the residual of
+    // the domain does not depend on the ones of the auxiliary equations.
+    template <class NeighborSet>
+    void computeColoring_(const std::vector<NeighborSet>& sparsityPattern)
+    {
+        size_t numDof = model_().numGridDof();
+
+        sparsityRows_.resize(numDof);
+        std::vector<std::vector<unsigned> > columnRows(numDof);
+        for (unsigned rowIdx = 0; rowIdx < numDof; ++rowIdx) {
+            auto& rowCols = sparsityRows_[rowIdx];
+            rowCols.clear();
+            for (unsigned colIdx : sparsityPattern[rowIdx]) {
+                if (colIdx >= numDof)
+                    continue;
+                rowCols.push_back(colIdx);
+                columnRows[colIdx].push_back(rowIdx);
             }
         }
 
-        // add the additional neighbors and degrees of freedom caused by the auxiliary
-        // equations
-        size_t numAuxMod = model.numAuxiliaryModules();
-        for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
-            model.auxiliaryModule(auxModIdx)->addNeighbors(sparsityPattern);
+        static const unsigned noColor = std::numeric_limits<unsigned>::max();
+        dofColor_.assign(numDof, noColor);
+
+        // colorUsedBy[colorIdx] is the index of the last DOF for which the color was
+        // found to be unavailable
+        std::vector<unsigned> colorUsedBy;
+        for (unsigned dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+            for (unsigned rowIdx : columnRows[dofIdx]) {
+                for (unsigned otherDofIdx : sparsityRows_[rowIdx]) {
+                    unsigned otherColor = dofColor_[otherDofIdx];
+                    if (otherColor != noColor)
+                        colorUsedBy[otherColor] = dofIdx;
+                }
+            }
 
-        // allocate raw matrix
-        jacobian_.reset(new SparseMatrixAdapter(simulator_()));
+            unsigned colorIdx = 0;
+            while (colorIdx < colorUsedBy.size() && colorUsedBy[colorIdx] == dofIdx)
+                ++colorIdx;
+            if (colorIdx == colorUsedBy.size())
+                colorUsedBy.push_back(noColor);
 
-        // create matrix structure based on sparsity pattern
-        jacobian_->reserve(sparsityPattern);
+            dofColor_[dofIdx] = colorIdx;
+        }
+
+        colorDofs_.clear();
+        colorDofs_.resize(colorUsedBy.size());
+        for (unsigned dofIdx = 0; dofIdx < numDof; ++dofIdx)
+            colorDofs_[dofColor_[dofIdx]].push_back(dofIdx);
     }
 
     // reset the global linear system of equations.
@@ -418,6 +661,19 @@ private:
 
         applyConstraintsToSolution_();
 
+        if (useColoredFiniteDifferences_) {
+            linearizeColored_();
+            applyConstraintsToLinearization_();
+            return;
+        }
+
+        if (reproducibleAssembly_) {
+            reproducibleElementLoop_([this](const Element& elem) -> void
+                                     { this->linearizeElement_(elem); });
+            applyConstraintsToLinearization_();
+            return;
+        }
+
         // to avoid a race condition if two threads handle an exception at the same time,
         // we use an explicit lock to control access to the exception storage object
         // amongst thread-local handlers
@@ -483,6 +739,321 @@ private:
         applyConstraintsToLinearization_();
     }
 
+    // linearize the whole system using finite differences of the global residual. all
+    // degrees of freedom of a color are perturbed at the same time, so the residual
+    // needs to be evaluated numColors*numEq + 1 times for forward or backward differences
+    // and 2*numColors*numEq + 1 times for central differences. each evaluation uses the
+    // multi-threaded element loop of linearizeResidualOnly_(). the perturbations and the
+    // kind of differences are the same as for the finite difference local linearizer.
+    void linearizeColored_()
+    {
+        auto& model = model_();
+        auto& solution = model.solution(/*timeIdx=*/0);
+        size_t numDof = model.numGridDof();
+        int differenceMethod = EWOMS_GET_PARAM(TypeTag, int, NumericDifferenceMethod);
+
+        // the weights of the primary variables may depend on the intensive quantities
+        // at the linearization point
+        updatePvWeights_ = true;
+        {
+            auto resetFn = [this]() -> void { this->updatePvWeights_ = false; };
+            auto resetGuard = Opm::make_guard(resetFn);
+            linearizeResidualOnly_();
+        }
+        coloredBaseResidual_ = residual_;
+        coloredSavedSolution_ = solution;
+
+        // the storage term of the beginning of the time step is written to the cache if
+        // the residual is evaluated in the first iteration. the perturbed evaluations
+        // must not do this, so we pretend to be in a later iteration.
+        auto& newtonMethod = model.newtonMethod();
+        int origIterationIdx = newtonMethod.numIterations();
+        newtonMethod.setIterationIndex(std::max(origIterationIdx, 1));
+
+        // make sure that the unperturbed state is restored even if the evaluation of a
+        // residual throws
+        auto restoreFn =
+            [this, &model, &solution, &newtonMethod, origIterationIdx]() -> void
+            {
+                solution = this->coloredSavedSolution_;
+                model.invalidateIntensiveQuantitiesCache(/*timeIdx=*/0);
+                this->residual_ = this->coloredBaseResidual_;
+                newtonMethod.setIterationIndex(origIterationIdx);
+            };
+        auto restoreGuard = Opm::make_guard(restoreFn);
+
+        coloredDeltas_.resize(numDof);
+        coloredDifferences_.resize(numEq);
+        for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+            coloredDifferences_[pvIdx].resize(numDof);
+
+        for (unsigned colorIdx = 0; colorIdx < colorDofs_.size(); ++colorIdx) {
+            const auto& dofs = colorDofs_[colorIdx];
+
+            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx) {
+                auto& diff = coloredDifferences_[pvIdx];
+                for (unsigned dofIdx : dofs)
+                    coloredDeltas_[dofIdx][pvIdx] = 0.0;
+
+                if (differenceMethod >= 0) {
+                    // calculate f(x + epsilon). use the difference which is actually
+                    // representable
+                    for (unsigned dofIdx : dofs) {
+                        Scalar& value = solution[dofIdx][pvIdx];
+                        value += model.numericDifferenceEpsilon(dofIdx, pvIdx);
+                        coloredDeltas_[dofIdx][pvIdx] +=
+                            value - coloredSavedSolution_[dofIdx][pvIdx];
+                    }
+                    model.invalidateIntensiveQuantitiesCache(/*timeIdx=*/0);
+                    linearizeResidualOnly_();
+                    diff = residual_;
+                }
+                else
+                    // backward differences, recycle f(x)
+                    diff = coloredBaseResidual_;
+
+                if (differenceMethod <= 0) {
+                    // calculate f(x - epsilon)
+                    for (unsigned dofIdx : dofs) {
+                        Scalar& value = solution[dofIdx][pvIdx];
+                        value =
+                            coloredSavedSolution_[dofIdx][pvIdx]
+                            - model.numericDifferenceEpsilon(dofIdx, pvIdx);
+                        coloredDeltas_[dofIdx][pvIdx] +=
+                            coloredSavedSolution_[dofIdx][pvIdx] - value;
+                    }
+                    model.invalidateIntensiveQuantitiesCache(/*timeIdx=*/0);
+                    linearizeResidualOnly_();
+                    diff -= residual_;
+                }
+                else
+                    // forward differences, recycle f(x)
+                    diff -= coloredBaseResidual_;
+
+                for (unsigned dofIdx : dofs)
+                    solution[dofIdx][pvIdx] = coloredSavedSolution_[dofIdx][pvIdx];
+            }
+
+            // scatter the columns of the current color into the Jacobian matrix. due to
+            // the coloring, each row exhibits at most one column of a given color.
+            MatrixBlock block;
+            for (unsigned rowIdx = 0; rowIdx < numDof; ++rowIdx) {
+                for (unsigned colIdx : sparsityRows_[rowIdx]) {
+                    if (dofColor_[colIdx] != colorIdx)
+                        continue;
+
+                    for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx) {
+                        Scalar delta = coloredDeltas_[colIdx][pvIdx];
+                        assert(delta > 0);
+                        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                            block[eqIdx][pvIdx] = coloredDifferences_[pvIdx][rowIdx][eqIdx]/delta;
+                    }
+                    jacobian_->addToBlock(rowIdx, colIdx, block);
+                    break;
+                }
+            }
+        }
+    }
+
+    // evaluate the residual of the whole spatial domain
+    void linearizeResidualOnly_()
+    {
+        residual_ = 0.0;
+
+        auto elementFn = [this](const Element& elem) -> void
+                         { this->evalElementResidual_(elem); };
+        if (reproducibleAssembly_)
+            reproducibleElementLoop_(elementFn);
+        else
+            threadedElementLoop_(elementFn);
+
+        applyConstraintsToResidual_();
+    }
+
+    // multiply the Jacobian matrix of the whole spatial domain with a vector without
+    // assembling the matrix
+    void applyJacobian_(const GlobalEqVector& x, GlobalEqVector& y)
+    {
+        y.resize(x.size());
+        y = 0.0;
+
+        auto elementFn = [this, &x, &y](const Element& elem) -> void
+                         { this->applyElementJacobian_(elem, x, y); };
+        if (reproducibleAssembly_) {
+            // an entry of the result receives contributions from all elements whose
+            // stencil contains the degree of freedom. to sum them up in the same order
+            // regardless of the number of threads, the elements are processed
+            // sequentially in this case.
+            ElementIterator elemIt = gridView_().template begin<0>();
+            const ElementIterator elemEndIt = gridView_().template end<0>();
+            for (; elemIt != elemEndIt; ++elemIt) {
+                const Element& elem = *elemIt;
+                if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
+                    continue;
+
+                elementFn(elem);
+            }
+        }
+        else
+            threadedElementLoop_(elementFn);
+
+        // the rows of constraint degrees of freedom are the identity
+        auto it = constraintsMap_.begin();
+        const auto& endIt = constraintsMap_.end();
+        for (; it != endIt; ++it)
+            y[it->first] = x[it->first];
+    }
+
+    // call a function for all elements which need to be linearized using all threads
+    template <class ElementFn>
+    void threadedElementLoop_(const ElementFn& elementFn)
+    {
+        // see linearize_() for why exceptions need to be bridged out of the parallel
+        // block this way
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            ElementIterator elemIt = threadedElemIt.beginParallel();
+            ElementIterator nextElemIt = elemIt;
+            try {
+                for (; !threadedElemIt.isFinished(elemIt); elemIt = nextElemIt) {
+                    nextElemIt = threadedElemIt.increment();
+                    if (!threadedElemIt.isFinished(nextElemIt)) {
+                        const auto& nextElem = *nextElemIt;
+                        if (linearizeNonLocalElements
+                            || nextElem.partitionType() == Dune::InteriorEntity)
+                        {
+                            model_().prefetch(nextElem);
+                            problem_().prefetch(nextElem);
+                        }
+                    }
+
+                    const Element& elem = *elemIt;
+                    if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
+                        continue;
+
+                    elementFn(elem);
+                }
+            }
+            catch(...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+                threadedElemIt.setFinished();
+            }
+        }  // parallel block
+
+        if(exceptionPtr) {
+            std::rethrow_exception(exceptionPtr);
+        }
+    }
+
+    // the residual of constraint degrees of freedom is zero
+    void applyConstraintsToResidual_()
+    {
+        if (!enableConstraints_())
+            return;
+
+        auto it = constraintsMap_.begin();
+        const auto& endIt = constraintsMap_.end();
+        for (; it != endIt; ++it)
+            residual_[it->first] = 0.0;
+    }
+
+    // call a function for all elements which need to be linearized such that the
+    // result does not depend on the number of threads. the groups of elements computed
+    // by computeElementColoring_() are processed one after another, the elements of a
+    // group are processed concurrently.
+    template <class ElementFn>
+    void reproducibleElementLoop_(const ElementFn& elementFn)
+    {
+        const auto& grid = gridView_().grid();
+
+        // see linearize_() for why exceptions need to be bridged out of the parallel
+        // block this way
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+
+        for (const auto& seeds : elementColorSeeds_) {
+            int numElements = static_cast<int>(seeds.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+            for (int i = 0; i < numElements; ++i) {
+                try {
+                    const auto& elem = grid.entity(seeds[static_cast<size_t>(i)]);
+                    elementFn(elem);
+                }
+                catch(...) {
+                    std::lock_guard<std::mutex> take(exceptionLock);
+                    exceptionPtr = std::current_exception();
+                }
+            }
+
+            if(exceptionPtr) {
+                std::rethrow_exception(exceptionPtr);
+            }
+        }
+    }
+
+    // evaluate the residual of an element without computing its local Jacobian
+    void evalElementResidual_(const Element& elem)
+    {
+        unsigned threadId = ThreadManager::threadId();
+
+        ElementContext& elemCtx = *elementCtx_[threadId];
+        auto& localResidual = model_().localResidual(threadId);
+
+        elemCtx.updateAll(elem);
+        if (updatePvWeights_)
+            model_().updatePVWeights(elemCtx);
+        localResidual.eval(elemCtx);
+
+        if (GET_PROP_VALUE(TypeTag, UseLinearizationLock))
+            globalMatrixMutex_.lock();
+
+        size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+        for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++ primaryDofIdx) {
+            unsigned globI = elemCtx.globalSpaceIndex(/*spaceIdx=*/primaryDofIdx, /*timeIdx=*/0);
+            const auto& localResid = localResidual.residual(primaryDofIdx);
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
+                residual_[globI][eqIdx] += Toolbox::value(localResid[eqIdx]);
+        }
+
+        if (GET_PROP_VALUE(TypeTag, UseLinearizationLock))
+            globalMatrixMutex_.unlock();
+    }
+
+    // multiply the local Jacobian matrix of an element with the respective entries of a
+    // vector and add the result to another vector
+    void applyElementJacobian_(const Element& elem, const GlobalEqVector& x, GlobalEqVector& y)
+    {
+        unsigned threadId = ThreadManager::threadId();
+
+        ElementContext& elemCtx = *elementCtx_[threadId];
+        auto& localLinearizer = model_().localLinearizer(threadId);
+        localLinearizer.linearize(elemCtx, elem);
+
+        // in contrast to the blocks of the Jacobian matrix, the entries of the result
+        // receive contributions from several elements even for cell centered
+        // discretizations, so they always need to be protected by the lock
+        std::lock_guard<std::mutex> lock(globalMatrixMutex_);
+
+        size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+        size_t numDof = elemCtx.numDof(/*timeIdx=*/0);
+        for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++ primaryDofIdx) {
+            unsigned globI = elemCtx.globalSpaceIndex(/*spaceIdx=*/primaryDofIdx, /*timeIdx=*/0);
+            for (unsigned dofIdx = 0; dofIdx < numDof; ++ dofIdx) {
+                unsigned globJ = elemCtx.globalSpaceIndex(/*spaceIdx=*/dofIdx, /*timeIdx=*/0);
+                localLinearizer.jacobian(dofIdx, primaryDofIdx).umv(x[globI], y[globJ]);
+            }
+        }
+    }
+
     // linearize an element in the interior of the process' grid partition
     void linearizeElement_(const Element& elem)
     {
@@ -509,6 +1080,10 @@ private:
             for (unsigned dofIdx = 0; dofIdx < elementCtx->numDof(/*timeIdx=*/0); ++ dofIdx) {
                 unsigned globJ = elementCtx->globalSpaceIndex(/*spaceIdx=*/dofIdx, /*timeIdx=*/0);
 
+                // only the diagonal blocks are assembled for matrix-free linear solvers
+                if (matrixFreeLinearization && globJ != globI)
+                    continue;
+
                 jacobian_->addToBlock(globJ, globI, localLinearizer.jacobian(dofIdx, primaryDofIdx));
             }
         }
@@ -573,6 +1148,22 @@ private:
     // the right-hand side
     GlobalEqVector residual_;
 
+    // the state required by the linearization using colored finite differences
+    bool useColoredFiniteDifferences_;
+    bool updatePvWeights_;
+    std::vector<std::vector<unsigned> > sparsityRows_;
+    std::vector<unsigned> dofColor_;
+    std::vector<std::vector<unsigned> > colorDofs_;
+    GlobalEqVector coloredBaseResidual_;
+    SolutionVector coloredSavedSolution_;
+    std::vector<VectorBlock> coloredDeltas_;
+    std::vector<GlobalEqVector> coloredDifferences_;
+
+    // the groups of elements which are linearized one after another if the result of
+    // the linearization must not depend on the number of threads
+    bool reproducibleAssembly_;
+    std::vector<std::vector<ElementSeed> > elementColorSeeds_;
+
 
     std::mutex globalMatrixMutex_;
 };
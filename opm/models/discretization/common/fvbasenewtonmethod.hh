@@ -145,6 +145,25 @@ protected:
         }
     }
 
+    /*!
+     * \brief Evaluate the residual of the current solution for the line search.
+     *
+     * This uses the residual-only path of the linearizer, i.e., the Jacobian matrix
+     * is not assembled.
+     */
+    void evalTrialResidual_(GlobalEqVector& residual)
+    {
+        model_().syncOverlap();
+
+        auto& linearizer = model_().linearizer();
+        linearizer.linearizeResidualOnly();
+        residual = linearizer.residual();
+
+        // make the residual consistent on the process borders
+        this->linearSolver_.setResidual(residual);
+        this->linearSolver_.getResidual(residual);
+    }
+
     /*!
      * \brief Indicates the beginning of a Newton iteration.
      */
@@ -33,6 +33,8 @@
 #include <opm/models/io/vtkmultiwriter.hh>
 #include <opm/models/io/restart.hh>
 #include <opm/models/discretization/common/restrictprolong.hh>
+#include <opm/models/nonlinear/timestepcontrollers.hh>
+#include <opm/models/utils/timer.hh>
 
 #include <opm/material/common/Unused.hpp>
 #include <opm/material/common/Exceptions.hpp>
@@ -71,6 +73,7 @@ private:
     typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
     typedef typename GET_PROP_TYPE(TypeTag, ThreadManager) ThreadManager;
     typedef typename GET_PROP_TYPE(TypeTag, NewtonMethod) NewtonMethod;
+    typedef typename GET_PROP_TYPE(TypeTag, TimeStepController) TimeStepController;
 
     typedef typename GET_PROP_TYPE(TypeTag, VertexMapper) VertexMapper;
     typedef typename GET_PROP_TYPE(TypeTag, ElementMapper) ElementMapper;
@@ -111,12 +114,18 @@ public:
     FvBaseProblem(Simulator& simulator)
         : nextTimeStepSize_(0.0)
         , gridView_(simulator.gridView())
-        , elementMapper_(gridView_, Dune::mcmgElementLayout())
-        , vertexMapper_(gridView_, Dune::mcmgVertexLayout())
+          // the mappers must number the entities in the same way as the model's ones,
+          // so they share the permutations computed by the vanguard
+        , elementMapper_(gridView_, Dune::mcmgElementLayout(),
+                         simulator.vanguard().elementPermutation())
+        , vertexMapper_(gridView_, Dune::mcmgVertexLayout(),
+                        simulator.vanguard().vertexPermutation())
         , boundingBoxMin_(std::numeric_limits<double>::max())
         , boundingBoxMax_(-std::numeric_limits<double>::max())
         , simulator_(simulator)
         , defaultVtkWriter_(0)
+        , enableTimeStepSnapshots_(EWOMS_GET_PARAM(TypeTag, bool, EnableTimeStepSnapshots))
+        , timeStepController_(simulator)
     {
         // calculate the bounding box of the local partition of the grid view
         VertexIterator vIt = gridView_.template begin<dim>();
@@ -150,7 +159,9 @@ public:
             std::string outputDir = asImp_().outputDir();
 
             defaultVtkWriter_ =
-                new VtkMultiWriter(asyncVtkOutput, gridView_, outputDir, asImp_().name());
+                new VtkMultiWriter(asyncVtkOutput, gridView_, outputDir, asImp_().name(),
+                                   /*multiFileName=*/"",
+                                   EWOMS_GET_PARAM(TypeTag, bool, EnableVtkCompression));
         }
     }
 
@@ -164,6 +175,7 @@ public:
     static void registerParameters()
     {
         Model::registerParameters();
+        TimeStepController::registerParameters();
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, MaxTimeStepSize,
                              "The maximum size to which all time steps are limited to [s]");
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, MinTimeStepSize,
@@ -173,6 +185,12 @@ public:
                              "before the simulation bails out");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableAsyncVtkOutput,
                              "Dispatch a separate thread to write the VTK output");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableVtkCompression,
+                             "Compress the VTK output using zlib. This requires the "
+                             "'appendedraw' VTK output format");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableTimeStepSnapshots,
+                             "Keep an in-memory copy of the model's state at the beginning "
+                             "of each time step to roll back failed time steps");
         EWOMS_REGISTER_PARAM(TypeTag, bool, ContinueOnConvergenceError,
                              "Continue with a non-converged solution instead of giving up "
                              "if we encounter a time step size smaller than the minimum time "
@@ -184,10 +202,12 @@ public:
      *        term for the solution of the previous time step.
      *
      * This is only relevant if the storage cache is enabled and is usually the case,
-     * i.e., this method only needs to be overwritten in rare corner cases.
+     * i.e., this method only needs to be overwritten in rare corner cases. The
+     * exception is if the initial guess of the Newton method is extrapolated from the
+     * solutions of the previous time steps.
      */
     bool recycleFirstIterationStorage() const
-    { return true; }
+    { return model().solutionExtrapolationOrder() == 0; }
 
     /*!
      * \brief Determine the directory for simulation output.
@@ -511,11 +531,21 @@ public:
         unsigned maxFails = asImp_().maxTimeIntegrationFailures();
         Scalar minTimeStepSize = asImp_().minTimeStepSize();
 
+        // save the state at the beginning of the time step. if the Newton method fails,
+        // the model returns to it without losing the cached quantities.
+        if (enableTimeStepSnapshots_)
+            model().createSnapshot();
+
+        Opm::Timer timer;
+        timer.start();
+
         std::string errorMessage;
         for (unsigned i = 0; i < maxFails; ++i) {
             bool converged = model().update();
-            if (converged)
+            if (converged) {
+                timeStepDone_(/*numFailures=*/i, timer.stop());
                 return;
+            }
 
             Scalar dt = simulator().timeStepSize();
             Scalar nextDt = dt / 2.0;
@@ -525,6 +555,7 @@ public:
                         std::cout << "Newton solver did not converge with minimum time step of "
                                   << dt << " seconds. Continuing with unconverged solution!\n"
                                   << std::flush;
+                    timeStepDone_(/*numFailures=*/i, timer.stop());
                     return;
                 }
                 else {
@@ -591,7 +622,7 @@ public:
             return nextTimeStepSize_;
 
         Scalar dtNext = std::min(EWOMS_GET_PARAM(TypeTag, Scalar, MaxTimeStepSize),
-                                 newtonMethod().suggestTimeStepSize(simulator().timeStepSize()));
+                                 timeStepController_.suggestTimeStepSize(simulator().timeStepSize()));
 
         if (dtNext < simulator().maxTimeStepSize()
             && simulator().maxTimeStepSize() < dtNext*2)
@@ -811,6 +842,36 @@ private:
     bool enableVtkOutput_() const
     { return EWOMS_GET_PARAM(TypeTag, bool, EnableVtkOutput); }
 
+    // pass the statistics of the time integration which just succeeded to the time
+    // step controller
+    void timeStepDone_(unsigned numFailures, double wallTime)
+    {
+        Opm::TimeStepReport<Scalar> report;
+        report.timeStepSize = simulator().timeStepSize();
+        report.numNewtonIterations = static_cast<unsigned>(newtonMethod().numIterations());
+        report.numLinearIterations = newtonMethod().numLinearIterations();
+        report.numFailures = numFailures;
+        report.maxRelativeChange = 0.0;
+        report.wallTime = wallTime;
+
+        // the relative change requires a loop over all degrees of freedom and a global
+        // reduction, so it is only computed if the controller uses it
+        if (TimeStepController::needsRelativeChange) {
+            const auto& uNew = model().solution(/*timeIdx=*/0);
+            const auto& uOld = model().solution(/*timeIdx=*/1);
+
+            Scalar maxChange = 0.0;
+            size_t numDof = model().numGridDof();
+            for (unsigned dofIdx = 0; dofIdx < numDof; ++dofIdx)
+                if (model().isLocalDof(dofIdx))
+                    maxChange = std::max(maxChange,
+                                         model().relativeDofError(dofIdx, uOld[dofIdx], uNew[dofIdx]));
+            report.maxRelativeChange = gridView().comm().max(maxChange);
+        }
+
+        timeStepController_.timeStepDone(report);
+    }
+
     //! Returns the implementation of the problem (i.e. static polymorphism)
     Implementation& asImp_()
     { return *static_cast<Implementation *>(this); }
@@ -829,6 +890,9 @@ private:
     // Attributes required for the actual simulation
     Simulator& simulator_;
     mutable VtkMultiWriter *defaultVtkWriter_;
+
+    bool enableTimeStepSnapshots_;
+    TimeStepController timeStepController_;
 };
 
 } // namespace Opm
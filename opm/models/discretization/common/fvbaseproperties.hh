@@ -168,6 +168,22 @@ NEW_PROP_TAG(ThreadsPerProcess);
 //! discretizations do not need this.)
 NEW_PROP_TAG(UseLinearizationLock);
 
+//! Linearize the global system of equations by perturbing structurally independent
+//! degrees of freedom simultaneously and taking finite differences of the global
+//! residual instead of using the local linearizer
+NEW_PROP_TAG(UseColoredFiniteDifferences);
+
+//! Specify which kind of finite differences ought to be used to numerically calculate
+//! partial derivatives (-1: backward, 0: central, 1: forward differences)
+NEW_PROP_TAG(NumericDifferenceMethod);
+
+//! The unweighted perturbation of the primary variables used for finite differences
+NEW_PROP_TAG(BaseEpsilon);
+
+//! Only assemble the diagonal blocks of the Jacobian matrix because the linear solver
+//! applies the Jacobian without the assembled matrix
+NEW_PROP_TAG(EnableMatrixFreeLinearization);
+
 // high-level simulation control
 
 //! Manages the simulation time
@@ -213,9 +229,21 @@ NEW_PROP_TAG(EnableAsyncVtkOutput);
  *   - Dune::VTK::base64
  *   - Dune::VTK::appendedraw
  *   - Dune::VTK::appendedbase64
+ *
+ * For Dune::VTK::appendedraw, the files are written by the native
+ * Opm::VtkAppendedRawWriter instead of Dune::VTKWriter.
  */
 NEW_PROP_TAG(VtkOutputFormat);
 
+/*!
+ * \brief Specify whether the data arrays of the VTK output ought to be
+ *        compressed using zlib.
+ *
+ * This only has an effect if the VtkOutputFormat property is set to
+ * Dune::VTK::appendedraw.
+ */
+NEW_PROP_TAG(EnableVtkCompression);
+
 //! Specify whether the some degrees of fredom can be constraint
 NEW_PROP_TAG(EnableConstraints);
 
@@ -246,6 +274,23 @@ NEW_PROP_TAG(MaxTimeStepDivisions);
  */
 NEW_PROP_TAG(ContinueOnConvergenceError);
 
+/*!
+ * \brief Keep an in-memory snapshot of the model's state at the beginning of each
+ *        time step.
+ *
+ * If the time integration fails, the snapshot is used to roll back the model
+ * instead of re-computing the cached quantities from scratch.
+ */
+NEW_PROP_TAG(EnableTimeStepSnapshots);
+
+/*!
+ * \brief The class which determines the size of the next time step.
+ *
+ * See opm/models/nonlinear/timestepcontrollers.hh for the available
+ * controllers.
+ */
+NEW_PROP_TAG(TimeStepController);
+
 /*!
  * \brief Specify whether all intensive quantities for the grid should be
  *        cached in the discretization.
@@ -265,6 +310,20 @@ NEW_PROP_TAG(EnableIntensiveQuantityCache);
  */
 NEW_PROP_TAG(EnableStorageCache);
 
+/*!
+ * \brief Specify whether global sums should be independent of the number of threads
+ *        and processes.
+ *
+ * If this is enabled, global sums are computed exactly using Opm::ReproducibleSum, so
+ * their results are bit-wise identical regardless of how the grid is distributed.
+ * Also, the contributions of the elements to the residual and to the Jacobian matrix
+ * are summed up in an order which does not depend on the number of threads. With this,
+ * the results of a simulation are bit-wise identical for any number of threads. They
+ * may still depend on the number of processes because the preconditioners of the
+ * linear solvers depend on the domain decomposition.
+ */
+NEW_PROP_TAG(EnableReproducibleSums);
+
 /*!
  * \brief Specify whether to use the already calculated solutions as
  *        starting values of the intensive quantities.
@@ -275,6 +334,16 @@ NEW_PROP_TAG(EnableStorageCache);
  */
 NEW_PROP_TAG(EnableThermodynamicHints);
 
+/*!
+ * \brief Specify the order of the polynomial which is used to extrapolate the
+ *        initial guess of the Newton method from the solutions of the previous
+ *        time steps.
+ *
+ * 0 disables the extrapolation, 1 extrapolates linearly using the last two
+ * solutions and 2 extrapolates quadratically using the last three solutions.
+ */
+NEW_PROP_TAG(SolutionExtrapolationOrder);
+
 // mappers from local to global DOF indices
 
 /*!
@@ -292,6 +361,17 @@ NEW_PROP_TAG(ElementMapper);
  */
 NEW_PROP_TAG(DofMapper);
 
+/*!
+ * \brief The ordering of the degrees of freedom.
+ *
+ * This can be "natural" (the order of the grid's index set), "rcm" (reverse
+ * Cuthill-McKee ordering of the connectivity graph) or "hilbert" (the order along a
+ * Hilbert space-filling curve). The latter two usually improve the memory locality of
+ * the linearization and of the linear solver on unstructured grids and reduce the
+ * fill-in of incomplete factorizations.
+ */
+NEW_PROP_TAG(DofOrdering);
+
 /*!
  * \brief The class which marks the border indices associated with the
  *        degrees of freedom on a process boundary.
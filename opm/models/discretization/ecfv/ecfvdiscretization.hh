@@ -56,9 +56,14 @@ SET_PROP(EcfvDiscretization, Stencil)
 private:
     typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
     typedef typename GET_PROP_TYPE(TypeTag, GridView) GridView;
+    typedef typename GET_PROP_TYPE(TypeTag, DofMapper) DofMapper;
 
 public:
-    typedef Opm::EcfvStencil<Scalar, GridView> type;
+    typedef Opm::EcfvStencil<Scalar,
+                             GridView,
+                             /*needFaceIntegrationPos=*/true,
+                             /*needFaceNormal=*/true,
+                             DofMapper> type;
 };
 
 //! Mapper for the degrees of freedoms.
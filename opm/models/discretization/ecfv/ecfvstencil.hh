@@ -54,7 +54,8 @@ namespace Opm {
 template <class Scalar,
           class GridView,
           bool needFaceIntegrationPos = true,
-          bool needFaceNormal = true>
+          bool needFaceNormal = true,
+          class ElementMapperType = Dune::MultipleCodimMultipleGeomTypeMapper<GridView> >
 class EcfvStencil
 {
     enum { dimWorld = GridView::dimensionworld };
@@ -63,7 +64,7 @@ class EcfvStencil
     typedef typename GridView::Intersection Intersection;
     typedef typename GridView::template Codim<0>::Entity Element;
 
-    typedef Dune::MultipleCodimMultipleGeomTypeMapper<GridView> ElementMapper;
+    typedef ElementMapperType ElementMapper;
 
     typedef Dune::FieldVector<CoordScalar, dimWorld> GlobalPosition;
 
@@ -121,7 +121,7 @@ public:
 
                 if (prepareGradients) {
                     // first, get the shape function's gradient in local coordinates
-                    std::vector<ShapeJacobian> localGradient;
+                    auto& localGradient = p1LocalGradient_;
                     localFE.localBasis().evaluateJacobian(localFacePos, localGradient);
 
                     // convert to a gradient in global space by
@@ -350,6 +350,10 @@ private:
     const LocalFiniteElement* localFiniteElement_;
     std::vector<Dune::FieldVector<Scalar, 1>> p1Value_[maxFap];
     DimVector p1Gradient_[maxFap][maxDof];
+
+    // scratch space for the gradients in local coordinates. this is a member to avoid
+    // allocating memory for each face of each element.
+    std::vector<ShapeJacobian> p1LocalGradient_;
 #endif // HAVE_DUNE_LOCALFUNCTIONS
 };
 
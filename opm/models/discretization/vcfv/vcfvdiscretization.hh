@@ -58,9 +58,10 @@ SET_PROP(VcfvDiscretization, Stencil)
 private:
     typedef typename GET_PROP_TYPE(TypeTag, GridView) GridView;
     typedef typename GridView::ctype CoordScalar;
+    typedef typename GET_PROP_TYPE(TypeTag, DofMapper) DofMapper;
 
 public:
-    typedef Opm::VcfvStencil<CoordScalar, GridView> type;
+    typedef Opm::VcfvStencil<CoordScalar, GridView, DofMapper> type;
 };
 
 //! Mapper for the degrees of freedoms.
@@ -464,7 +464,9 @@ VcfvScvGeometries<Scalar, /*dim=*/3, ElementType::cube>::scvGeoms_[
  * are constructed by connecting the element's center with each edge
  * of the element.
  */
-template <class Scalar, class GridView>
+template <class Scalar,
+          class GridView,
+          class VertexMapperType = Dune::MultipleCodimMultipleGeomTypeMapper<GridView> >
 class VcfvStencil
 {
     enum{dim = GridView::dimension};
@@ -724,7 +726,7 @@ private:
 
 public:
     //! exported Mapper type
-    typedef Dune::MultipleCodimMultipleGeomTypeMapper<GridView> Mapper;
+    typedef VertexMapperType Mapper;
 
     class ScvGeometry
     {
@@ -1044,7 +1046,7 @@ public:
         const auto& localFiniteElement = feCache_.get(element_.type());
         const auto& geom = element_.geometry();
 
-        std::vector<ShapeJacobian> localJac;
+        auto& localJac = centerLocalJac_;
 
         for (unsigned scvIdx = 0; scvIdx < numVertices; ++ scvIdx) {
             const auto& localCenter = subContVol[scvIdx].localGeometry().center();
@@ -1107,6 +1109,12 @@ public:
         return element_.template subEntity<dim>(static_cast<int>(dofIdx));
     }
 
+    /*!
+     * \brief Return the element to which the stencil refers.
+     */
+    const Element& element() const
+    { return element_; }
+
 private:
 #if __GNUC__ || __clang__
 #pragma GCC diagnostic push
@@ -1352,6 +1360,9 @@ private:
 
 #if HAVE_DUNE_LOCALFUNCTIONS
     static LocalFiniteElementCache feCache_;
+
+    //! scratch space for the shape function gradients used by updateCenterGradients()
+    std::vector<ShapeJacobian> centerLocalJac_;
 #endif // HAVE_DUNE_LOCALFUNCTIONS
 
     //! local coordinate of element center
@@ -1381,9 +1392,9 @@ private:
 };
 
 #if HAVE_DUNE_LOCALFUNCTIONS
-template<class Scalar, class GridView>
-typename VcfvStencil<Scalar, GridView>::LocalFiniteElementCache
-VcfvStencil<Scalar, GridView>::feCache_;
+template<class Scalar, class GridView, class VertexMapperType>
+typename VcfvStencil<Scalar, GridView, VertexMapperType>::LocalFiniteElementCache
+VcfvStencil<Scalar, GridView, VertexMapperType>::feCache_;
 #endif // HAVE_DUNE_LOCALFUNCTIONS
 
 } // namespace Opm
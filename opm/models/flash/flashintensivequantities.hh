@@ -106,7 +106,8 @@ public:
 
         const auto& priVars = elemCtx.primaryVars(dofIdx, timeIdx);
         const auto& problem = elemCtx.problem();
-        Scalar flashTolerance = EWOMS_GET_PARAM(TypeTag, Scalar, FlashTolerance);
+        const auto& model = elemCtx.model();
+        Scalar flashTolerance = model.flashTolerance();
 
         // extract the total molar densities of the components
         ComponentVector cTotal;
@@ -114,6 +115,8 @@ public:
             cTotal[compIdx] = priVars.makeEvaluation(cTot0Idx + compIdx, timeIdx);
 
         const auto *hint = elemCtx.thermodynamicHint(dofIdx, timeIdx);
+        const auto *flashHint =
+            (timeIdx == 0) ? model.flashHint(elemCtx.globalSpaceIndex(dofIdx, timeIdx)) : 0;
         if (hint) {
             // use the same fluid state as the one of the hint, but
             // make sure that we don't overwrite the temperature
@@ -122,6 +125,16 @@ public:
             fluidState_.assign(hint->fluidState());
             fluidState_.setTemperature(T);
         }
+        else if (flashHint) {
+            // start with the result of the flash calculation of the previous Newton
+            // iteration
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                fluidState_.setPressure(phaseIdx, flashHint->pressure[phaseIdx]);
+                fluidState_.setSaturation(phaseIdx, flashHint->saturation[phaseIdx]);
+                for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                    fluidState_.setMoleFraction(phaseIdx, compIdx, flashHint->moleFraction[phaseIdx][compIdx]);
+            }
+        }
         else
             FlashSolver::guessInitial(fluidState_, cTotal);
 
@@ -38,6 +38,7 @@
 #include "flashintensivequantities.hh"
 #include "flashextensivequantities.hh"
 #include "flashindices.hh"
+#include "flashnewtonmethod.hh"
 
 #include <opm/models/common/multiphasebasemodel.hh>
 #include <opm/models/common/energymodule.hh>
@@ -48,8 +49,10 @@
 #include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
 #include <opm/material/constraintsolvers/NcpFlash.hpp>
 
+#include <algorithm>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace Opm {
 template <class TypeTag>
@@ -79,6 +82,9 @@ SET_SCALAR_PROP(FlashModel, FlashTolerance, -1.0);
 //! the Model property
 SET_TYPE_PROP(FlashModel, Model, Opm::FlashModel<TypeTag>);
 
+//! Use the Newton method which stores the results of the flash calculations
+SET_TYPE_PROP(FlashModel, NewtonMethod, Opm::FlashNewtonMethod<TypeTag>);
+
 //! the PrimaryVariables property
 SET_TYPE_PROP(FlashModel, PrimaryVariables, Opm::FlashPrimaryVariables<TypeTag>);
 
@@ -186,6 +192,7 @@ class FlashModel
 
     typedef typename GET_PROP_TYPE(TypeTag, Indices) Indices;
 
+    enum { numPhases = GET_PROP_VALUE(TypeTag, NumPhases) };
     enum { numComponents = GET_PROP_VALUE(TypeTag, NumComponents) };
     enum { enableDiffusion = GET_PROP_VALUE(TypeTag, EnableDiffusion) };
     enum { enableEnergy = GET_PROP_VALUE(TypeTag, EnableEnergy) };
@@ -194,9 +201,22 @@ class FlashModel
     typedef Opm::EnergyModule<TypeTag, enableEnergy> EnergyModule;
 
 public:
+    /*!
+     * \brief The result of a flash calculation which is used as the initial guess for
+     *        the next flash calculation of the same degree of freedom.
+     */
+    struct FlashHint
+    {
+        Scalar pressure[numPhases];
+        Scalar saturation[numPhases];
+        Scalar moleFraction[numPhases][numComponents];
+    };
+
     FlashModel(Simulator& simulator)
         : ParentType(simulator)
-    {}
+    {
+        flashTolerance_ = EWOMS_GET_PARAM(TypeTag, Scalar, FlashTolerance);
+    }
 
     /*!
      * \brief Register all run-time parameters for the immiscible model.
@@ -300,6 +320,88 @@ public:
         return FluidSystem::molarMass(compIdx);
     }
 
+    /*!
+     * \brief Returns the tolerance of the flash solver.
+     */
+    Scalar flashTolerance() const
+    { return flashTolerance_; }
+
+    /*!
+     * \brief Returns the result of the last flash calculation for a degree of freedom.
+     *
+     * If thermodynamic hints are disabled or no flash has been calculated for the
+     * degree of freedom yet, this method returns 0. The intensive quantity cache does
+     * not need to be enabled for this.
+     *
+     * \param globalDofIdx The global space index of the degree of freedom
+     */
+    const FlashHint* flashHint(unsigned globalDofIdx) const
+    {
+        if (globalDofIdx >= flashHintValid_.size() || !flashHintValid_[globalDofIdx])
+            return 0;
+
+        return &flashHints_[globalDofIdx];
+    }
+
+    /*!
+     * \brief Store the results of the flash calculations of the current Newton iteration.
+     *
+     * The results are taken from the intensive quantities stored by the model. These
+     * are available if thermodynamic hints are enabled, regardless of whether the
+     * intensive quantity cache is enabled. This method needs to be called before the
+     * stored intensive quantities get invalidated by the update of the solution.
+     */
+    void storeFlashHints()
+    {
+        if (!this->enableThermodynamicHints_)
+            return;
+
+        size_t numGridDof = this->numGridDof();
+        if (flashHints_.size() != numGridDof) {
+            flashHints_.resize(numGridDof);
+            flashHintValid_.assign(numGridDof, 0);
+        }
+
+        for (unsigned dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
+            const auto* intQuants = this->storedIntensiveQuantities_(dofIdx);
+            if (!intQuants)
+                continue;
+
+            const auto& fs = intQuants->fluidState();
+            FlashHint& hint = flashHints_[dofIdx];
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                hint.pressure[phaseIdx] = Opm::getValue(fs.pressure(phaseIdx));
+                hint.saturation[phaseIdx] = Opm::getValue(fs.saturation(phaseIdx));
+                for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                    hint.moleFraction[phaseIdx][compIdx] = Opm::getValue(fs.moleFraction(phaseIdx, compIdx));
+            }
+            flashHintValid_[dofIdx] = 1;
+        }
+    }
+
+    /*!
+     * \copydoc FvBaseDiscretization::updateFailed
+     */
+    void updateFailed()
+    {
+        ParentType::updateFailed();
+
+        // the results of the flash calculations of the failed attempt are bad initial
+        // guesses for the next one
+        invalidateFlashHints_();
+    }
+
+    /*!
+     * \copydoc FvBaseDiscretization::restoreSnapshot
+     */
+    void restoreSnapshot()
+    {
+        ParentType::restoreSnapshot();
+
+        // the flash hints stem from solutions which were discarded
+        invalidateFlashHints_();
+    }
+
     void registerOutputModules_()
     {
         ParentType::registerOutputModules_();
@@ -311,6 +413,15 @@ public:
         if (enableEnergy)
             this->addOutputModule(new Opm::VtkEnergyModule<TypeTag>(this->simulator_));
     }
+
+private:
+    void invalidateFlashHints_()
+    { std::fill(flashHintValid_.begin(), flashHintValid_.end(), 0); }
+
+    Scalar flashTolerance_;
+
+    std::vector<FlashHint> flashHints_;
+    std::vector<unsigned char> flashHintValid_;
 };
 
 } // namespace Opm
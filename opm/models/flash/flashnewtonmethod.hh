@@ -0,0 +1,77 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::FlashNewtonMethod
+ */
+#ifndef EWOMS_FLASH_NEWTON_METHOD_HH
+#define EWOMS_FLASH_NEWTON_METHOD_HH
+
+#include "flashproperties.hh"
+
+namespace Opm {
+
+/*!
+ * \ingroup FlashModel
+ *
+ * \brief A newton solver which is specific to the compositional flash model.
+ *
+ * Before the solution is updated, the results of the flash calculations of the
+ * current iteration are stored by the model, so that they can be used as the
+ * initial guess of the flash solver in the next iteration.
+ */
+template <class TypeTag>
+class FlashNewtonMethod : public GET_PROP_TYPE(TypeTag, DiscNewtonMethod)
+{
+    typedef typename GET_PROP_TYPE(TypeTag, DiscNewtonMethod) ParentType;
+    typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
+    typedef typename GET_PROP_TYPE(TypeTag, SolutionVector) SolutionVector;
+    typedef typename GET_PROP_TYPE(TypeTag, GlobalEqVector) GlobalEqVector;
+
+public:
+    FlashNewtonMethod(Simulator& simulator) : ParentType(simulator)
+    {}
+
+protected:
+    friend NewtonMethod<TypeTag>;
+    friend ParentType;
+
+    /*!
+     * \copydoc FvBaseNewtonMethod::update_
+     */
+    void update_(SolutionVector& nextSolution,
+                 const SolutionVector& currentSolution,
+                 const GlobalEqVector& solutionUpdate,
+                 const GlobalEqVector& currentResidual)
+    {
+        // the intensive quantities cache gets invalidated by the update, so we need
+        // to extract the flash results before
+        this->model().storeFlashHints();
+
+        ParentType::update_(nextSolution, currentSolution, solutionUpdate, currentResidual);
+    }
+};
+} // namespace Opm
+
+#endif
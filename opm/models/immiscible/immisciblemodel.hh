@@ -47,6 +47,7 @@
 #include <opm/material/fluidsystems/SinglePhaseFluidSystem.hpp>
 #include <opm/material/fluidsystems/TwoPhaseImmiscibleFluidSystem.hpp>
 
+#include <algorithm>
 #include <sstream>
 #include <string>
 
@@ -204,6 +205,7 @@ class ImmiscibleModel
     typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
     typedef typename GET_PROP_TYPE(TypeTag, Indices) Indices;
     typedef typename GET_PROP_TYPE(TypeTag, FluidSystem) FluidSystem;
+    typedef typename GET_PROP_TYPE(TypeTag, PrimaryVariables) PrimaryVariables;
 
     enum { numComponents = FluidSystem::numComponents };
 
@@ -279,6 +281,19 @@ public:
         return oss.str();
     }
 
+    /*!
+     * \copydoc FvBaseDiscretization::limitExtrapolatedPrimaryVars
+     */
+    void limitExtrapolatedPrimaryVars(PrimaryVariables& priVars,
+                                      const PrimaryVariables& oldPriVars OPM_UNUSED) const
+    {
+        // saturations are always in the range [0, 1]
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases - 1; ++phaseIdx) {
+            Scalar& S = priVars[Indices::saturation0Idx + phaseIdx];
+            S = std::max<Scalar>(0.0, std::min<Scalar>(1.0, S));
+        }
+    }
+
     /*!
      * \copydoc FvBaseDiscretization::updateBegin
      */
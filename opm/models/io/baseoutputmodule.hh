@@ -300,6 +300,25 @@ protected:
         }
     }
 
+    /*!
+     * \brief Bring a buffer which is indexed by the model's (possibly reordered) indices
+     *        into the order of the grid's index set which the writers expect.
+     *
+     * This modifies the buffer in place, so it must be called exactly once after the
+     * buffer has been filled.
+     */
+    template <class Buffer>
+    void restoreNaturalOrder_(Buffer& buffer, BufferType bufferType) const
+    {
+        const auto& model = simulator_.model();
+        if (bufferType == DofBuffer)
+            model.dofMapper().restoreNaturalOrder(buffer);
+        else if (bufferType == VertexBuffer)
+            model.vertexMapper().restoreNaturalOrder(buffer);
+        else if (bufferType == ElementBuffer)
+            model.elementMapper().restoreNaturalOrder(buffer);
+    }
+
     /*!
      * \brief Add a buffer containing scalar quantities to the result file.
      */
@@ -308,6 +327,8 @@ protected:
                              ScalarBuffer& buffer,
                              BufferType bufferType = DofBuffer)
     {
+        restoreNaturalOrder_(buffer, bufferType);
+
         if (bufferType == DofBuffer)
             DiscBaseOutputModule::attachScalarDofData_(baseWriter, buffer, name);
         else if (bufferType == VertexBuffer)
@@ -326,6 +347,8 @@ protected:
                              VectorBuffer& buffer,
                              BufferType bufferType = DofBuffer)
     {
+        restoreNaturalOrder_(buffer, bufferType);
+
         if (bufferType == DofBuffer)
             DiscBaseOutputModule::attachVectorDofData_(baseWriter, buffer, name);
         else if (bufferType == VertexBuffer)
@@ -344,6 +367,8 @@ protected:
                              TensorBuffer& buffer,
                              BufferType bufferType = DofBuffer)
     {
+        restoreNaturalOrder_(buffer, bufferType);
+
         if (bufferType == DofBuffer)
             DiscBaseOutputModule::attachTensorDofData_(baseWriter, buffer, name);
         else if (bufferType == VertexBuffer)
@@ -367,6 +392,8 @@ protected:
             std::string eqName = simulator_.model().primaryVarName(i);
             snprintf(name, 512, pattern, eqName.c_str());
 
+            restoreNaturalOrder_(buffer[i], bufferType);
+
             if (bufferType == DofBuffer)
                 DiscBaseOutputModule::attachScalarDofData_(baseWriter, buffer[i], name);
             else if (bufferType == VertexBuffer)
@@ -392,6 +419,8 @@ protected:
             oss << i;
             snprintf(name, 512, pattern, oss.str().c_str());
 
+            restoreNaturalOrder_(buffer[i], bufferType);
+
             if (bufferType == DofBuffer)
                 DiscBaseOutputModule::attachScalarDofData_(baseWriter, buffer[i], name);
             else if (bufferType == VertexBuffer)
@@ -415,6 +444,8 @@ protected:
         for (unsigned i = 0; i < numPhases; ++i) {
             snprintf(name, 512, pattern, FluidSystem::phaseName(i));
 
+            restoreNaturalOrder_(buffer[i], bufferType);
+
             if (bufferType == DofBuffer)
                 DiscBaseOutputModule::attachScalarDofData_(baseWriter, buffer[i], name);
             else if (bufferType == VertexBuffer)
@@ -438,6 +469,8 @@ protected:
         for (unsigned i = 0; i < numComponents; ++i) {
             snprintf(name, 512, pattern, FluidSystem::componentName(i));
 
+            restoreNaturalOrder_(buffer[i], bufferType);
+
             if (bufferType == DofBuffer)
                 DiscBaseOutputModule::attachScalarDofData_(baseWriter, buffer[i], name);
             else if (bufferType == VertexBuffer)
@@ -464,6 +497,8 @@ protected:
                          FluidSystem::phaseName(i),
                          FluidSystem::componentName(j));
 
+                restoreNaturalOrder_(buffer[i][j], bufferType);
+
                 if (bufferType == DofBuffer)
                     DiscBaseOutputModule::attachScalarDofData_(baseWriter, buffer[i][j], name);
                 else if (bufferType == VertexBuffer)
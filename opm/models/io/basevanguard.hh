@@ -29,6 +29,7 @@
 
 #include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/reorderedmapper.hh>
 
 #include <dune/common/version.hh>
 
@@ -38,6 +39,7 @@
 
 #include <type_traits>
 #include <memory>
+#include <string>
 
 BEGIN_PROPERTIES
 
@@ -49,6 +51,7 @@ NEW_PROP_TAG(GridViewLevel);
 NEW_PROP_TAG(GridFile);
 NEW_PROP_TAG(GridGlobalRefinements);
 NEW_PROP_TAG(Simulator);
+NEW_PROP_TAG(DofOrdering);
 
 END_PROPERTIES
 
@@ -64,6 +67,9 @@ class BaseVanguard
     typedef typename GET_PROP_TYPE(TypeTag, Grid) Grid;
     typedef typename GET_PROP_TYPE(TypeTag, GridView) GridView;
     typedef typename GET_PROP_TYPE(TypeTag, Vanguard) Implementation;
+    typedef Opm::EntityPermutation<GridView> EntityPermutation;
+
+    enum { dim = GridView::dimension };
 
 #if HAVE_DUNE_FEM
     typedef typename GET_PROP_TYPE(TypeTag, GridPart) GridPart;
@@ -96,6 +102,26 @@ public:
     { return *gridPart_; }
 #endif
 
+    /*!
+     * \brief Returns the permutation of the elements which is specified by the
+     *        DofOrdering parameter.
+     *
+     * The permutation is shared by the element mappers of the model and of the
+     * problem. It is computed when it is requested for the first time after the
+     * grid view has been updated, i.e., after the grid has been load balanced.
+     */
+    std::shared_ptr<const EntityPermutation> elementPermutation() const
+    { return entityPermutation_(elementPermutation_, /*codim=*/0); }
+
+    /*!
+     * \brief Returns the permutation of the vertices which is specified by the
+     *        DofOrdering parameter.
+     *
+     * \copydetails elementPermutation()
+     */
+    std::shared_ptr<const EntityPermutation> vertexPermutation() const
+    { return entityPermutation_(vertexPermutation_, /*codim=*/dim); }
+
     /*!
      * \brief Returns the number of times the grid has been changed since its creation.
      *
@@ -142,9 +168,26 @@ protected:
 #else
         gridView_.reset(new GridView(asImp_().grid().leafGridView()));
 #endif
+
+        // the permutations of the entities refer to the previous grid view
+        elementPermutation_.reset();
+        vertexPermutation_.reset();
     }
 
 private:
+    std::shared_ptr<const EntityPermutation>
+    entityPermutation_(std::shared_ptr<const EntityPermutation>& permutation, int codim) const
+    {
+        if (!permutation) {
+            std::string ordering = EWOMS_GET_PARAM(TypeTag, std::string, DofOrdering);
+            permutation = std::make_shared<const EntityPermutation>(gridView(),
+                                                                    codim,
+                                                                    Opm::dofOrderingFromString(ordering));
+        }
+
+        return permutation;
+    }
+
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
 
@@ -156,6 +199,9 @@ private:
     std::unique_ptr<GridPart> gridPart_;
 #endif
     std::unique_ptr<GridView> gridView_;
+
+    mutable std::shared_ptr<const EntityPermutation> elementPermutation_;
+    mutable std::shared_ptr<const EntityPermutation> vertexPermutation_;
 };
 
 } // namespace Opm
@@ -191,6 +191,10 @@ protected:
                     fractureMapper_.addFractureEdge(vertexIndices[0], vertexIndices[1]);
             }
         }
+
+        // the fracture topology does not change anymore, so we can use
+        // the flat representation for the queries
+        fractureMapper_.finalize();
     }
 
 private:
@@ -0,0 +1,513 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::VtkAppendedRawWriter
+ */
+#ifndef EWOMS_VTK_APPENDED_RAW_WRITER_HH
+#define EWOMS_VTK_APPENDED_RAW_WRITER_HH
+
+#include <opm/models/io/baseoutputwriter.hh>
+
+#include <dune/grid/common/gridenums.hh>
+#include <dune/grid/io/file/vtk/common.hh>
+
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \brief Writes VTU files in the "appended raw" format directly from the
+ *        buffers of the output modules.
+ *
+ * In contrast to Dune::VTKWriter, this class does not evaluate a virtual
+ * function for each entity and component, but converts the contiguous
+ * ScalarBuffer, VectorBuffer and TensorBuffer objects to the output format
+ * in one go. The data arrays can optionally be compressed using zlib.
+ *
+ * Like the ASCII output of Dune::VTKWriter, only the interior elements and the
+ * vertices which they reference are written. The geometry and the topology of
+ * the grid are only encoded once and then reused for all files until
+ * gridChanged() is called.
+ */
+template <class GridView, class ElementMapper, class VertexMapper>
+class VtkAppendedRawWriter
+{
+    enum { dim = GridView::dimension };
+
+    typedef BaseOutputWriter::ScalarBuffer ScalarBuffer;
+    typedef BaseOutputWriter::VectorBuffer VectorBuffer;
+    typedef BaseOutputWriter::TensorBuffer TensorBuffer;
+
+    typedef std::vector<char> EncodedBlock;
+
+    // a field which has been attached to the writer. Exactly one of the
+    // buffer pointers is non-null.
+    struct Field
+    {
+        std::string name;
+        bool isCellData;
+        unsigned numComponents;
+        const ScalarBuffer *scalarBuf;
+        const VectorBuffer *vectorBuf;
+        const TensorBuffer *tensorBuf;
+        unsigned tensorColIdx;
+    };
+
+    // a data array of a piece file
+    struct DataArray
+    {
+        std::string name;
+        std::string type;
+        unsigned numComponents;
+        const EncodedBlock *block;
+    };
+
+public:
+    VtkAppendedRawWriter(const GridView& gridView,
+                         const ElementMapper& elementMapper,
+                         const VertexMapper& vertexMapper,
+                         bool compress)
+        : gridView_(gridView)
+        , elementMapper_(elementMapper)
+        , vertexMapper_(vertexMapper)
+        , compress_(compress)
+        , topologyValid_(false)
+    {
+#if !HAVE_ZLIB
+        if (compress_)
+            throw std::runtime_error("Compression of VTK files requires zlib");
+#endif
+    }
+
+    /*!
+     * \brief Notify the writer that the grid has changed.
+     *
+     * This causes the geometry and the topology of the grid to be re-encoded
+     * the next time a file is written.
+     */
+    void gridChanged()
+    { topologyValid_ = false; }
+
+    /*!
+     * \brief Forget about all fields which have been attached so far.
+     */
+    void clear()
+    { fields_.clear(); }
+
+    /*!
+     * \brief Add a scalar field to the output.
+     *
+     * The buffer must stay valid until the file has been written.
+     */
+    void addScalarData(const ScalarBuffer& buf, const std::string& name, bool isCellData)
+    {
+        Field field = makeField_(name, isCellData);
+        field.numComponents = 1;
+        field.scalarBuf = &buf;
+        fields_.push_back(field);
+    }
+
+    /*!
+     * \brief Add a vectorial field to the output.
+     *
+     * The buffer must stay valid until the file has been written.
+     */
+    void addVectorData(const VectorBuffer& buf, const std::string& name, bool isCellData)
+    {
+        Field field = makeField_(name, isCellData);
+        field.numComponents = buf.empty() ? 1 : static_cast<unsigned>(buf[0].size());
+        // two-dimensional vectors are padded with zeros because ParaView does not
+        // consider them to be vectors otherwise
+        if (field.numComponents == 2)
+            field.numComponents = 3;
+        field.vectorBuf = &buf;
+        fields_.push_back(field);
+    }
+
+    /*!
+     * \brief Add a tensorial field to the output.
+     *
+     * Each column of the tensors is written as a separate data array. The
+     * buffer must stay valid until the file has been written.
+     */
+    void addTensorData(const TensorBuffer& buf, const std::string& name, bool isCellData)
+    {
+        if (buf.empty())
+            return;
+
+        for (unsigned colIdx = 0; colIdx < buf[0].N(); ++colIdx) {
+            std::ostringstream oss;
+            oss << name << "[" << colIdx << "]";
+
+            Field field = makeField_(oss.str(), isCellData);
+            field.numComponents = static_cast<unsigned>(buf[0].M());
+            field.tensorBuf = &buf;
+            field.tensorColIdx = colIdx;
+            fields_.push_back(field);
+        }
+    }
+
+    /*!
+     * \brief Write the attached fields to disk.
+     *
+     * For sequential runs, this produces a single VTU file, for parallel runs
+     * each process writes the VTU file for its piece of the grid and the first
+     * process additionally writes a PVTU file which ties the pieces
+     * together. The naming scheme of the files is the same as the one used by
+     * Dune::VTKWriter.
+     *
+     * \return The name of the file which ought to be referenced by the
+     *         multi-file of the time series.
+     */
+    std::string write(const std::string& outputDir,
+                      const std::string& name,
+                      int commRank,
+                      int commSize)
+    {
+        if (!topologyValid_)
+            updateTopology_();
+
+        if (commSize == 1) {
+            std::string fileName = outputDir + "/" + name + ".vtu";
+            writePiece_(fileName);
+            return fileName;
+        }
+
+        std::string pvtuName = pieceName_(name, commSize, -1) + ".pvtu";
+        writePiece_(outputDir + "/" + pieceName_(name, commSize, commRank) + ".vtu");
+        if (commRank == 0)
+            writePvtu_(outputDir + "/" + pvtuName, name, commSize);
+
+        return outputDir + "/" + pvtuName;
+    }
+
+private:
+    Field makeField_(const std::string& name, bool isCellData) const
+    {
+        Field field;
+        field.name = name;
+        field.isCellData = isCellData;
+        field.numComponents = 0;
+        field.scalarBuf = nullptr;
+        field.vectorBuf = nullptr;
+        field.tensorBuf = nullptr;
+        field.tensorColIdx = 0;
+        return field;
+    }
+
+    // returns the file name of a piece (or the one of the PVTU file if procIdx
+    // is negative) without the extension
+    static std::string pieceName_(const std::string& name, int commSize, int procIdx)
+    {
+        char tmp[32];
+        std::ostringstream oss;
+        std::snprintf(tmp, sizeof(tmp), "s%04d-", commSize);
+        oss << tmp;
+        if (procIdx >= 0) {
+            std::snprintf(tmp, sizeof(tmp), "p%04d-", procIdx);
+            oss << tmp;
+        }
+        oss << name;
+        return oss.str();
+    }
+
+    static const char *byteOrder_()
+    {
+        const uint16_t tmp = 1;
+        return (*reinterpret_cast<const char*>(&tmp) == 1) ? "LittleEndian" : "BigEndian";
+    }
+
+    // encode the geometry and the topology of the grid
+    void updateTopology_()
+    {
+        // the cells. like Dune::VTKWriter, only the interior elements are written. the
+        // points are the vertices of these elements in the order in which they are
+        // encountered first, so vertices which are only part of overlap or ghost
+        // elements are omitted.
+        std::vector<int32_t> pointIndices(static_cast<size_t>(vertexMapper_.size()), -1);
+        std::vector<float> points;
+        std::vector<int32_t> connectivity;
+        std::vector<int32_t> offsets;
+        std::vector<uint8_t> types;
+        cellElementIndices_.clear();
+        pointVertexIndices_.clear();
+        auto eIt = gridView_.template begin</*codim=*/0, Dune::Interior_Partition>();
+        const auto& eEndIt = gridView_.template end</*codim=*/0, Dune::Interior_Partition>();
+        for (; eIt != eEndIt; ++eIt) {
+            const auto& elem = *eIt;
+            const auto& geomType = elem.type();
+
+            cellElementIndices_.push_back(static_cast<size_t>(elementMapper_.index(elem)));
+
+            const auto& geom = elem.geometry();
+            int numVertices = static_cast<int>(elem.subEntities(dim));
+            for (int i = 0; i < numVertices; ++i) {
+                int duneIdx = Dune::VTK::renumber(geomType, i);
+                size_t vertexIdx = static_cast<size_t>(vertexMapper_.subIndex(elem, duneIdx, dim));
+                if (pointIndices[vertexIdx] < 0) {
+                    pointIndices[vertexIdx] = static_cast<int32_t>(pointVertexIndices_.size());
+                    pointVertexIndices_.push_back(vertexIdx);
+
+                    const auto& pos = geom.corner(duneIdx);
+                    for (unsigned j = 0; j < 3; ++j)
+                        points.push_back((j < pos.size()) ? static_cast<float>(pos[j]) : 0.0f);
+                }
+                connectivity.push_back(pointIndices[vertexIdx]);
+            }
+            offsets.push_back(static_cast<int32_t>(connectivity.size()));
+            types.push_back(static_cast<uint8_t>(Dune::VTK::geometryType(geomType)));
+        }
+        numCells_ = cellElementIndices_.size();
+        numPoints_ = pointVertexIndices_.size();
+
+        encode_(pointsBlock_, points);
+        encode_(connectivityBlock_, connectivity);
+        encode_(offsetsBlock_, offsets);
+        encode_(typesBlock_, types);
+
+        topologyValid_ = true;
+    }
+
+    // convert a field to single precision floating point values and encode it
+    void encodeField_(EncodedBlock& block, const Field& field) const
+    {
+        size_t numEntities = field.isCellData ? numCells_ : numPoints_;
+        unsigned numComps = field.numComponents;
+
+        std::vector<float> values(numEntities*numComps, 0.0f);
+        for (size_t i = 0; i < numEntities; ++i) {
+            size_t idx = field.isCellData ? cellElementIndices_[i] : pointVertexIndices_[i];
+            float *dest = values.data() + i*numComps;
+
+            if (field.scalarBuf)
+                dest[0] = static_cast<float>((*field.scalarBuf)[idx]);
+            else if (field.vectorBuf) {
+                const auto& v = (*field.vectorBuf)[idx];
+                for (unsigned compIdx = 0; compIdx < v.size() && compIdx < numComps; ++compIdx)
+                    dest[compIdx] = static_cast<float>(v[compIdx]);
+            }
+            else {
+                const auto& t = (*field.tensorBuf)[idx];
+                for (unsigned compIdx = 0; compIdx < numComps; ++compIdx)
+                    dest[compIdx] = static_cast<float>(t[compIdx][field.tensorColIdx]);
+            }
+        }
+
+        encode_(block, values);
+    }
+
+    // encode the contents of an array as a data block of the appended
+    // section. If compression is enabled, the whole array is compressed as a
+    // single block.
+    template <class T>
+    void encode_(EncodedBlock& block, const std::vector<T>& data) const
+    {
+        block.clear();
+
+        uint64_t numBytes = data.size()*sizeof(T);
+        const char *bytes = reinterpret_cast<const char*>(data.data());
+
+#if HAVE_ZLIB
+        if (compress_) {
+            if (numBytes == 0) {
+                const uint64_t header[3] = { 0, 0, 0 };
+                appendBytes_(block, header, sizeof(header));
+                return;
+            }
+
+            uLongf compressedSize = compressBound(static_cast<uLong>(numBytes));
+            std::vector<Bytef> compressed(compressedSize);
+            int ret = compress2(compressed.data(),
+                                &compressedSize,
+                                reinterpret_cast<const Bytef*>(bytes),
+                                static_cast<uLong>(numBytes),
+                                Z_DEFAULT_COMPRESSION);
+            if (ret != Z_OK)
+                throw std::runtime_error("Compressing the data of a VTK file failed");
+
+            // header: number of blocks, block size, size of the last
+            // block, compressed size of each block
+            const uint64_t header[4] = { 1, numBytes, numBytes, compressedSize };
+            appendBytes_(block, header, sizeof(header));
+            appendBytes_(block, compressed.data(), compressedSize);
+            return;
+        }
+#endif
+
+        appendBytes_(block, &numBytes, sizeof(numBytes));
+        appendBytes_(block, bytes, numBytes);
+    }
+
+    static void appendBytes_(EncodedBlock& block, const void *data, size_t numBytes)
+    {
+        const char *bytes = static_cast<const char*>(data);
+        block.insert(block.end(), bytes, bytes + numBytes);
+    }
+
+    static void writeDataArrayHeaders_(std::ostream& os,
+                                       const std::vector<DataArray>& arrays,
+                                       size_t firstIdx,
+                                       size_t lastIdx,
+                                       uint64_t& offset)
+    {
+        for (size_t i = firstIdx; i < lastIdx; ++i) {
+            const auto& array = arrays[i];
+            os << "    <DataArray type=\"" << array.type << "\"";
+            if (!array.name.empty())
+                os << " Name=\"" << array.name << "\"";
+            os << " NumberOfComponents=\"" << array.numComponents << "\""
+               << " format=\"appended\" offset=\"" << offset << "\"/>\n";
+            offset += array.block->size();
+        }
+    }
+
+    void writePiece_(const std::string& fileName) const
+    {
+        // encode the fields
+        std::vector<EncodedBlock> fieldBlocks(fields_.size());
+        for (size_t fieldIdx = 0; fieldIdx < fields_.size(); ++fieldIdx)
+            encodeField_(fieldBlocks[fieldIdx], fields_[fieldIdx]);
+
+        // collect all data arrays in the order in which they appear in the file
+        std::vector<DataArray> arrays;
+        for (int isCellData = 0; isCellData < 2; ++isCellData)
+            for (size_t fieldIdx = 0; fieldIdx < fields_.size(); ++fieldIdx)
+                if (fields_[fieldIdx].isCellData == static_cast<bool>(isCellData))
+                    arrays.push_back(DataArray{fields_[fieldIdx].name,
+                                               "Float32",
+                                               fields_[fieldIdx].numComponents,
+                                               &fieldBlocks[fieldIdx]});
+        size_t numPointArrays = 0;
+        for (const auto& field : fields_)
+            if (!field.isCellData)
+                ++numPointArrays;
+        size_t numFieldArrays = arrays.size();
+        arrays.push_back(DataArray{"", "Float32", 3, &pointsBlock_});
+        arrays.push_back(DataArray{"connectivity", "Int32", 1, &connectivityBlock_});
+        arrays.push_back(DataArray{"offsets", "Int32", 1, &offsetsBlock_});
+        arrays.push_back(DataArray{"types", "UInt8", 1, &typesBlock_});
+
+        std::ofstream os(fileName.c_str(), std::ios::out | std::ios::binary);
+        if (!os)
+            throw std::runtime_error("Could not open file '"+fileName+"' for writing");
+
+        os << "<?xml version=\"1.0\"?>\n"
+           << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\""
+           << " byte_order=\"" << byteOrder_() << "\" header_type=\"UInt64\"";
+        if (compress_)
+            os << " compressor=\"vtkZLibDataCompressor\"";
+        os << ">\n"
+           << " <UnstructuredGrid>\n"
+           << "  <Piece NumberOfPoints=\"" << numPoints_ << "\""
+           << " NumberOfCells=\"" << numCells_ << "\">\n";
+
+        uint64_t offset = 0;
+        os << "   <PointData>\n";
+        writeDataArrayHeaders_(os, arrays, 0, numPointArrays, offset);
+        os << "   </PointData>\n"
+           << "   <CellData>\n";
+        writeDataArrayHeaders_(os, arrays, numPointArrays, numFieldArrays, offset);
+        os << "   </CellData>\n"
+           << "   <Points>\n";
+        writeDataArrayHeaders_(os, arrays, numFieldArrays, numFieldArrays + 1, offset);
+        os << "   </Points>\n"
+           << "   <Cells>\n";
+        writeDataArrayHeaders_(os, arrays, numFieldArrays + 1, arrays.size(), offset);
+        os << "   </Cells>\n"
+           << "  </Piece>\n"
+           << " </UnstructuredGrid>\n"
+           << " <AppendedData encoding=\"raw\">\n"
+           << "_";
+        for (const auto& array : arrays)
+            os.write(array.block->data(), static_cast<std::streamsize>(array.block->size()));
+        os << "\n"
+           << " </AppendedData>\n"
+           << "</VTKFile>\n";
+    }
+
+    void writePvtu_(const std::string& fileName, const std::string& name, int commSize) const
+    {
+        std::ofstream os(fileName.c_str());
+        if (!os)
+            throw std::runtime_error("Could not open file '"+fileName+"' for writing");
+
+        os << "<?xml version=\"1.0\"?>\n"
+           << "<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\""
+           << " byte_order=\"" << byteOrder_() << "\" header_type=\"UInt64\">\n"
+           << " <PUnstructuredGrid GhostLevel=\"0\">\n";
+
+        os << "  <PPointData>\n";
+        for (const auto& field : fields_)
+            if (!field.isCellData)
+                os << "   <PDataArray type=\"Float32\" Name=\"" << field.name << "\""
+                   << " NumberOfComponents=\"" << field.numComponents << "\"/>\n";
+        os << "  </PPointData>\n"
+           << "  <PCellData>\n";
+        for (const auto& field : fields_)
+            if (field.isCellData)
+                os << "   <PDataArray type=\"Float32\" Name=\"" << field.name << "\""
+                   << " NumberOfComponents=\"" << field.numComponents << "\"/>\n";
+        os << "  </PCellData>\n"
+           << "  <PPoints>\n"
+           << "   <PDataArray type=\"Float32\" NumberOfComponents=\"3\"/>\n"
+           << "  </PPoints>\n";
+
+        for (int procIdx = 0; procIdx < commSize; ++procIdx)
+            os << "  <Piece Source=\"" << pieceName_(name, commSize, procIdx) << ".vtu\"/>\n";
+
+        os << " </PUnstructuredGrid>\n"
+           << "</VTKFile>\n";
+    }
+
+    const GridView gridView_;
+    const ElementMapper& elementMapper_;
+    const VertexMapper& vertexMapper_;
+    bool compress_;
+
+    std::vector<Field> fields_;
+
+    // the encoded geometry and topology of the grid
+    bool topologyValid_;
+    size_t numPoints_;
+    size_t numCells_;
+    std::vector<size_t> cellElementIndices_;
+    std::vector<size_t> pointVertexIndices_;
+    EncodedBlock pointsBlock_;
+    EncodedBlock connectivityBlock_;
+    EncodedBlock offsetsBlock_;
+    EncodedBlock typesBlock_;
+};
+} // namespace Opm
+
+#endif
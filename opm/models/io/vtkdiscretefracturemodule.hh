@@ -296,6 +296,7 @@ public:
                 char name[512];
                 snprintf(name, 512, "fractureFilterVelocity_%s", FluidSystem::phaseName(phaseIdx));
 
+                this->restoreNaturalOrder_(fractureVelocity_[phaseIdx], ParentType::DofBuffer);
                 DiscBaseOutputModule::attachVectorDofData_(baseWriter, fractureVelocity_[phaseIdx], name);
             }
         }
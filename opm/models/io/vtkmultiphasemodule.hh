@@ -349,6 +349,7 @@ public:
                 char name[512];
                 snprintf(name, 512, "filterVelocity_%s", FluidSystem::phaseName(phaseIdx));
 
+                this->restoreNaturalOrder_(velocity_[phaseIdx], ParentType::DofBuffer);
                 DiscBaseOutputModule::attachVectorDofData_(baseWriter, velocity_[phaseIdx], name);
             }
         }
@@ -365,6 +366,7 @@ public:
                 char name[512];
                 snprintf(name, 512, "gradP_%s", FluidSystem::phaseName(phaseIdx));
 
+                this->restoreNaturalOrder_(potentialGradient_[phaseIdx], ParentType::DofBuffer);
                 DiscBaseOutputModule::attachVectorDofData_(baseWriter,
                                                            potentialGradient_[phaseIdx],
                                                            name);
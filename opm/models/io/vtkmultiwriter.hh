@@ -31,6 +31,7 @@
 #include "vtkscalarfunction.hh"
 #include "vtkvectorfunction.hh"
 #include "vtktensorfunction.hh"
+#include "vtkappendedrawwriter.hh"
 
 #include <opm/models/io/baseoutputwriter.hh>
 #include <opm/models/parallel/tasklets.hh>
@@ -47,6 +48,7 @@
 #endif
 
 #include <list>
+#include <memory>
 #include <string>
 #include <limits>
 #include <sstream>
@@ -74,7 +76,12 @@ class VtkMultiWriter : public BaseOutputWriter
         {
             std::string fileName;
             // write the actual data as vtu or vtp (plus the pieces file in the parallel case)
-            if (multiWriter_.commSize_ > 1)
+            if (multiWriter_.rawWriter_)
+                fileName = multiWriter_.rawWriter_->write(multiWriter_.outputDir_,
+                                                          multiWriter_.curOutFileName_,
+                                                          multiWriter_.commRank_,
+                                                          multiWriter_.commSize_);
+            else if (multiWriter_.commSize_ > 1)
                 fileName = multiWriter_.curWriter_->pwrite(/*name=*/multiWriter_.curOutFileName_,
                                                            /*path=*/multiWriter_.outputDir_,
                                                            /*extendPath=*/"",
@@ -99,6 +106,8 @@ class VtkMultiWriter : public BaseOutputWriter
     typedef Dune::MultipleCodimMultipleGeomTypeMapper<GridView> VertexMapper;
     typedef Dune::MultipleCodimMultipleGeomTypeMapper<GridView> ElementMapper;
 
+    typedef Opm::VtkAppendedRawWriter<GridView, ElementMapper, VertexMapper> RawWriter;
+
 public:
     typedef BaseOutputWriter::Scalar Scalar;
     typedef BaseOutputWriter::Vector Vector;
@@ -110,11 +119,20 @@ public:
     typedef Dune::VTKWriter<GridView> VtkWriter;
     typedef std::shared_ptr< Dune::VTKFunction< GridView > > FunctionPtr;
 
+    /*!
+     * \brief Create a multi-file writer.
+     *
+     * If the output format is Dune::VTK::appendedraw, the files are written
+     * by VtkAppendedRawWriter instead of Dune::VTKWriter. In this case, the
+     * 'compress' argument specifies whether the data arrays are compressed
+     * using zlib; for all other formats it is ignored.
+     */
     VtkMultiWriter(bool asyncWriting,
                    const GridView& gridView,
                    const std::string& outputDir,
                    const std::string& simName = "",
-                   std::string multiFileName = "")
+                   std::string multiFileName = "",
+                   bool compress = false)
         : gridView_(gridView)
         , elementMapper_(gridView, Dune::mcmgElementLayout())
         , vertexMapper_(gridView, Dune::mcmgVertexLayout())
@@ -133,6 +151,10 @@ public:
 
         commRank_ = gridView.comm().rank();
         commSize_ = gridView.comm().size();
+
+        // the native writer only produces unstructured grids
+        if (vtkFormat == Dune::VTK::appendedraw && dim > 1)
+            rawWriter_.reset(new RawWriter(gridView_, elementMapper_, vertexMapper_, compress));
     }
 
     ~VtkMultiWriter()
@@ -162,6 +184,9 @@ public:
     {
         elementMapper_.update();
         vertexMapper_.update();
+
+        if (rawWriter_)
+            rawWriter_->gridChanged();
     }
 
     /*!
@@ -181,7 +206,8 @@ public:
         curTime_ = t;
         curOutFileName_ = fileName_();
 
-        curWriter_ = new VtkWriter(gridView_, Dune::VTK::conforming);
+        if (!rawWriter_)
+            curWriter_ = new VtkWriter(gridView_, Dune::VTK::conforming);
         ++curWriterNum_;
     }
 
@@ -234,6 +260,11 @@ public:
     {
         sanitizeScalarBuffer_(buf);
 
+        if (rawWriter_) {
+            rawWriter_->addScalarData(buf, name, /*isCellData=*/false);
+            return;
+        }
+
         typedef Opm::VtkScalarFunction<GridView, VertexMapper> VtkFn;
         FunctionPtr fnPtr(new VtkFn(name,
                                     gridView_,
@@ -262,6 +293,11 @@ public:
     {
         sanitizeScalarBuffer_(buf);
 
+        if (rawWriter_) {
+            rawWriter_->addScalarData(buf, name, /*isCellData=*/true);
+            return;
+        }
+
         typedef Opm::VtkScalarFunction<GridView, ElementMapper> VtkFn;
         FunctionPtr fnPtr(new VtkFn(name,
                                     gridView_,
@@ -291,6 +327,11 @@ public:
     {
         sanitizeVectorBuffer_(buf);
 
+        if (rawWriter_) {
+            rawWriter_->addVectorData(buf, name, /*isCellData=*/false);
+            return;
+        }
+
         typedef Opm::VtkVectorFunction<GridView, VertexMapper> VtkFn;
         FunctionPtr fnPtr(new VtkFn(name,
                                     gridView_,
@@ -305,6 +346,11 @@ public:
      */
     void attachTensorVertexData(TensorBuffer& buf, std::string name)
     {
+        if (rawWriter_) {
+            rawWriter_->addTensorData(buf, name, /*isCellData=*/false);
+            return;
+        }
+
         typedef Opm::VtkTensorFunction<GridView, VertexMapper> VtkFn;
 
         for (unsigned colIdx = 0; colIdx < buf[0].N(); ++colIdx) {
@@ -340,6 +386,11 @@ public:
     {
         sanitizeVectorBuffer_(buf);
 
+        if (rawWriter_) {
+            rawWriter_->addVectorData(buf, name, /*isCellData=*/true);
+            return;
+        }
+
         typedef Opm::VtkVectorFunction<GridView, ElementMapper> VtkFn;
         FunctionPtr fnPtr(new VtkFn(name,
                                     gridView_,
@@ -354,6 +405,11 @@ public:
      */
     void attachTensorElementData(TensorBuffer& buf, std::string name)
     {
+        if (rawWriter_) {
+            rawWriter_->addTensorData(buf, name, /*isCellData=*/true);
+            return;
+        }
+
         typedef Opm::VtkTensorFunction<GridView, ElementMapper> VtkFn;
 
         for (unsigned colIdx = 0; colIdx < buf[0].N(); ++colIdx) {
@@ -524,6 +580,8 @@ private:
         // discard managed objects and the current VTK writer
         delete curWriter_;
         curWriter_ = nullptr;
+        if (rawWriter_)
+            rawWriter_->clear();
         while (managedScalarBuffers_.begin() != managedScalarBuffers_.end()) {
             delete managedScalarBuffers_.front();
             managedScalarBuffers_.pop_front();
@@ -547,6 +605,7 @@ private:
     int commRank_; // rank of the current process in the communicator
 
     VtkWriter *curWriter_;
+    std::unique_ptr<RawWriter> rawWriter_;
     double curTime_;
     std::string curOutFileName_;
     int curWriterNum_;
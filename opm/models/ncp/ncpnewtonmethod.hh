@@ -74,16 +74,14 @@ protected:
     friend ParentType;
     friend NewtonMethod<TypeTag>;
 
-    void preSolve_(const SolutionVector& currentSolution OPM_UNUSED,
-                   const GlobalEqVector& currentResidual)
+    Scalar residualError_(const GlobalEqVector& residual) const
     {
         const auto& constraintsMap = this->model().linearizer().constraintsMap();
-        this->lastError_ = this->error_;
 
         // calculate the error as the maximum weighted tolerance of
         // the solution's residual
-        this->error_ = 0;
-        for (unsigned dofIdx = 0; dofIdx < currentResidual.size(); ++dofIdx) {
+        Scalar error = 0;
+        for (unsigned dofIdx = 0; dofIdx < residual.size(); ++dofIdx) {
             // do not consider auxiliary DOFs for the error
             if (dofIdx >= this->model().numGridDof() || this->model().dofTotalVolume(dofIdx) <= 0.0)
                 continue;
@@ -94,25 +92,16 @@ protected:
                     continue;
             }
 
-            const auto& r = currentResidual[dofIdx];
+            const auto& r = residual[dofIdx];
             for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx) {
                 if (ncp0EqIdx <= eqIdx && eqIdx < Indices::ncp0EqIdx + numPhases)
                     continue;
-                this->error_ =
-                    std::max(std::abs(r[eqIdx]*this->model().eqWeight(dofIdx, eqIdx)),
-                             this->error_);
+                error = std::max(std::abs(r[eqIdx]*this->model().eqWeight(dofIdx, eqIdx)), error);
             }
         }
 
         // take the other processes into account
-        this->error_ = this->comm_.max(this->error_);
-
-        // make sure that the error never grows beyond the maximum
-        // allowed one
-        if (this->error_ > EWOMS_GET_PARAM(TypeTag, Scalar, NewtonMaxError))
-            throw Opm::NumericalIssue("Newton: Error "+std::to_string(double(this->error_))+
-                                        +" is larger than maximum allowed error of "
-                                        +std::to_string(double(EWOMS_GET_PARAM(TypeTag, Scalar, NewtonMaxError))));
+        return this->comm_.max(error);
     }
 
     /*!
@@ -44,7 +44,10 @@
 #include <dune/common/version.hh>
 #include <dune/common/parallel/mpihelper.hh>
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <sstream>
 
 #include <unistd.h>
@@ -110,6 +113,9 @@ NEW_PROP_TAG(LinearSolverBackend);
 //! Specifies whether the Newton method should print messages or not
 NEW_PROP_TAG(NewtonVerbose);
 
+//! Specifies whether global sums are independent of the number of threads and processes
+NEW_PROP_TAG(EnableReproducibleSums);
+
 //! Specifies the type of the class which writes out the Newton convergence
 NEW_PROP_TAG(NewtonConvergenceWriter);
 
@@ -146,6 +152,12 @@ NEW_PROP_TAG(NewtonTargetIterations);
 //! Number of maximum iterations for the Newton method.
 NEW_PROP_TAG(NewtonMaxIterations);
 
+//! Specifies whether the Newton updates should be damped by a backtracking line search
+NEW_PROP_TAG(NewtonEnableLineSearch);
+
+//! The smallest fraction of the Newton update which is considered by the line search
+NEW_PROP_TAG(NewtonLineSearchMinFactor);
+
 // set default values for the properties
 SET_TYPE_PROP(NewtonMethod, NewtonMethod, Opm::NewtonMethod<TypeTag>);
 SET_TYPE_PROP(NewtonMethod, NewtonConvergenceWriter, Opm::NullConvergenceWriter<TypeTag>);
@@ -157,6 +169,8 @@ SET_SCALAR_PROP(NewtonMethod, NewtonTolerance, 1e-8);
 SET_SCALAR_PROP(NewtonMethod, NewtonMaxError, 1e100);
 SET_INT_PROP(NewtonMethod, NewtonTargetIterations, 10);
 SET_INT_PROP(NewtonMethod, NewtonMaxIterations, 18);
+SET_BOOL_PROP(NewtonMethod, NewtonEnableLineSearch, false);
+SET_SCALAR_PROP(NewtonMethod, NewtonLineSearchMinFactor, 0.125);
 
 END_PROPERTIES
 
@@ -201,7 +215,12 @@ public:
         error_ = 1e100;
         tolerance_ = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonTolerance);
 
+        // if the results are reproducible, print the errors with all digits so that
+        // the convergence histories of different runs can be compared
+        exactErrorOutput_ = EWOMS_GET_PARAM(TypeTag, bool, EnableReproducibleSums);
+
         numIterations_ = 0;
+        numLinearIterations_ = 0;
     }
 
     /*!
@@ -230,6 +249,12 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, NewtonMaxError,
                              "The maximum error tolerated by the Newton "
                              "method to which does not cause an abort");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, NewtonEnableLineSearch,
+                             "Damp the Newton updates using a backtracking line "
+                             "search");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, NewtonLineSearchMinFactor,
+                             "The smallest fraction of the Newton update which is "
+                             "tried by the line search");
     }
 
     /*!
@@ -279,6 +304,16 @@ public:
     int numIterations() const
     { return numIterations_; }
 
+    /*!
+     * \brief Returns the total number of iterations of the linear solver since the
+     *        Newton method was invoked.
+     *
+     * This is zero if the linear solver backend does not report its number of
+     * iterations.
+     */
+    unsigned numLinearIterations() const
+    { return numLinearIterations_; }
+
     /*!
      * \brief Set the index of current iteration.
      *
@@ -412,6 +447,7 @@ public:
                 linearSolver_.setMatrix(jacobian);
                 solutionUpdate = 0.0;
                 bool converged = linearSolver_.solve(solutionUpdate);
+                numLinearIterations_ += linearIterations_(linearSolver_, 0);
                 solveTimer_.stop();
 
                 if (!converged) {
@@ -439,7 +475,12 @@ public:
                 asImp_().postSolve_(currentSolution,
                                     residual,
                                     solutionUpdate);
+                bool enableLineSearch = EWOMS_GET_PARAM(TypeTag, bool, NewtonEnableLineSearch);
+                if (enableLineSearch)
+                    asImp_().saveUpdateState_();
                 asImp_().update_(nextSolution, currentSolution, solutionUpdate, residual);
+                if (enableLineSearch)
+                    asImp_().lineSearch_(nextSolution, currentSolution, solutionUpdate, residual);
                 updateTimer_.stop();
 
                 if (asImp_().verbose_() && isatty(fileno(stdout)))
@@ -604,6 +645,7 @@ protected:
     void begin_(const SolutionVector& u  OPM_UNUSED)
     {
         numIterations_ = 0;
+        numLinearIterations_ = 0;
 
         if (EWOMS_GET_PARAM(TypeTag, bool, NewtonWriteConvergence))
             convergenceWriter_.beginTimeStep();
@@ -655,14 +697,33 @@ protected:
     void preSolve_(const SolutionVector& currentSolution  OPM_UNUSED,
                    const GlobalEqVector& currentResidual)
     {
-        const auto& constraintsMap = model().linearizer().constraintsMap();
         lastError_ = error_;
         Scalar newtonMaxError = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonMaxError);
 
+        error_ = asImp_().residualError_(currentResidual);
+
+        // make sure that the error never grows beyond the maximum
+        // allowed one
+        if (error_ > newtonMaxError)
+            throw Opm::NumericalIssue("Newton: Error "+std::to_string(double(error_))
+                                        +" is larger than maximum allowed error of "
+                                        +std::to_string(double(newtonMaxError)));
+    }
+
+    /*!
+     * \brief Returns the error of a residual.
+     *
+     * The error is defined as the maximum of the weighted residual over all
+     * degrees of freedom of all processes.
+     */
+    Scalar residualError_(const GlobalEqVector& residual) const
+    {
+        const auto& constraintsMap = model().linearizer().constraintsMap();
+
         // calculate the error as the maximum weighted tolerance of
         // the solution's residual
-        error_ = 0;
-        for (unsigned dofIdx = 0; dofIdx < currentResidual.size(); ++dofIdx) {
+        Scalar error = 0;
+        for (unsigned dofIdx = 0; dofIdx < residual.size(); ++dofIdx) {
             // do not consider auxiliary DOFs for the error
             if (dofIdx >= model().numGridDof() || model().dofTotalVolume(dofIdx) <= 0.0)
                 continue;
@@ -673,20 +734,13 @@ protected:
                     continue;
             }
 
-            const auto& r = currentResidual[dofIdx];
+            const auto& r = residual[dofIdx];
             for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx)
-                error_ = Opm::max(std::abs(r[eqIdx] * model().eqWeight(dofIdx, eqIdx)), error_);
+                error = Opm::max(std::abs(r[eqIdx] * model().eqWeight(dofIdx, eqIdx)), error);
         }
 
         // take the other processes into account
-        error_ = comm_.max(error_);
-
-        // make sure that the error never grows beyond the maximum
-        // allowed one
-        if (error_ > newtonMaxError)
-            throw Opm::NumericalIssue("Newton: Error "+std::to_string(double(error_))
-                                        +" is larger than maximum allowed error of "
-                                        +std::to_string(double(newtonMaxError)));
+        return comm_.max(error);
     }
 
     /*!
@@ -792,6 +846,94 @@ protected:
         }
     }
 
+    /*!
+     * \brief Damp the update of the current iteration using a backtracking line
+     *        search.
+     *
+     * The full Newton update is kept if it reduces the error of the residual
+     * sufficiently (i.e., if it fulfills the Armijo condition). Otherwise, the update
+     * is halved until this is the case or until it would become smaller than the
+     * fraction given by the NewtonLineSearchMinFactor parameter. When this method is
+     * called, nextSolution already contains the result of the full update.
+     *
+     * \param nextSolution The solution vector after the current iteration
+     * \param currentSolution The solution vector after the last iteration
+     * \param solutionUpdate The delta vector as calculated by solving the linear system
+     *                       of equations
+     * \param origResidual The residual vector of the current Newton-Raphson iteraton
+     */
+    void lineSearch_(SolutionVector& nextSolution,
+                     const SolutionVector& currentSolution,
+                     const GlobalEqVector& solutionUpdate,
+                     const GlobalEqVector& origResidual)
+    {
+        // evaluating the trial residuals may overwrite the residual of the linearizer,
+        // so we need to keep a copy
+        const GlobalEqVector currentResidual(origResidual);
+
+        // the sufficient decrease parameter of the Armijo condition
+        static const Scalar armijoFactor = 1e-4;
+        Scalar minFactor = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonLineSearchMinFactor);
+
+        GlobalEqVector trialResidual(currentResidual.size());
+        GlobalEqVector scaledUpdate(solutionUpdate.size());
+
+        // the storage term of the beginning of the time step is written to the cache
+        // if the residual is evaluated in the first iteration. the line search must
+        // not do this, so we pretend to be in a later iteration.
+        int origNumIterations = numIterations_;
+        numIterations_ = std::max(numIterations_, 1);
+
+        Scalar lambda = 1.0;
+        while (true) {
+            asImp_().evalTrialResidual_(trialResidual);
+            Scalar trialError = asImp_().residualError_(trialResidual);
+            if (std::isfinite(trialError) && trialError <= (1.0 - armijoFactor*lambda)*error_)
+                break;
+            if (lambda/2 < minFactor)
+                break;
+
+            lambda /= 2;
+            scaledUpdate = solutionUpdate;
+            scaledUpdate *= lambda;
+
+            // the trial update must start from the same state as the full one, so any
+            // bookkeeping done by the rejected updates needs to be undone
+            asImp_().restoreUpdateState_();
+            asImp_().update_(nextSolution, currentSolution, scaledUpdate, currentResidual);
+        }
+
+        numIterations_ = origNumIterations;
+
+        if (lambda < 1.0)
+            endIterMsg() << ", line search factor: " << lambda;
+    }
+
+    /*!
+     * \brief Evaluate the residual of the current solution for the line search.
+     */
+    void evalTrialResidual_(GlobalEqVector& residual)
+    { model().globalResidual(residual); }
+
+    /*!
+     * \brief Save the state of the Newton method which is modified by update_().
+     *
+     * This is only called if the line search is enabled. Implementations which keep
+     * track of things like switched primary variables need to save this information
+     * here so that the line search can try several updates.
+     */
+    void saveUpdateState_()
+    { }
+
+    /*!
+     * \brief Restore the state which was saved by the last call to saveUpdateState_().
+     *
+     * This is called by the line search before it retries an update using a smaller
+     * step.
+     */
+    void restoreUpdateState_()
+    { }
+
     /*!
      * \brief Update the primary variables for a degree of freedom which is constraint.
      */
@@ -859,8 +1001,13 @@ protected:
             throw Opm::NumericalIssue("post processing of the problem failed");
 
         if (asImp_().verbose_()) {
+            std::ostringstream errorStream;
+            if (exactErrorOutput_)
+                errorStream.precision(std::numeric_limits<Scalar>::max_digits10);
+            errorStream << error_;
+
             std::cout << "Newton iteration " << numIterations_ << ""
-                      << " error: " << error_
+                      << " error: " << errorStream.str()
                       << endIterMsg().str() << "\n" << std::flush;
         }
     }
@@ -924,6 +1071,16 @@ protected:
     static bool enableConstraints_()
     { return GET_PROP_VALUE(TypeTag, EnableConstraints); }
 
+    // the number of iterations of the last linear solve if the backend provides it
+    template <class LinSolver>
+    static auto linearIterations_(const LinSolver& linSolver, int)
+        -> decltype(static_cast<unsigned>(linSolver.iterations()))
+    { return static_cast<unsigned>(linSolver.iterations()); }
+
+    template <class LinSolver>
+    static unsigned linearIterations_(const LinSolver& linSolver OPM_UNUSED, long)
+    { return 0; }
+
     Simulator& simulator_;
 
     Opm::Timer prePostProcessTimer_;
@@ -936,10 +1093,14 @@ protected:
     Scalar error_;
     Scalar lastError_;
     Scalar tolerance_;
+    bool exactErrorOutput_;
 
     // actual number of iterations done so far
     int numIterations_;
 
+    // number of iterations of the linear solver done so far
+    unsigned numLinearIterations_;
+
     // the linear solver
     LinearSolverBackend linearSolver_;
 
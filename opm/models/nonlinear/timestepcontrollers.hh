@@ -0,0 +1,359 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Classes which determine the size of the next time step.
+ *
+ * The time step controller used by a simulation is specified by the
+ * TimeStepController property. After each successful time integration, the
+ * problem passes a TimeStepReport to the controller's timeStepDone() method and
+ * asks it for the size of the next time step via suggestTimeStepSize().
+ * Since computing the maximum relative change of the primary variables requires
+ * a loop over all degrees of freedom and a global reduction, it is only computed
+ * if the controller's \c needsRelativeChange attribute is true.
+ */
+#ifndef EWOMS_TIME_STEP_CONTROLLERS_HH
+#define EWOMS_TIME_STEP_CONTROLLERS_HH
+
+#include <opm/models/utils/propertysystem.hh>
+#include <opm/models/utils/parametersystem.hh>
+
+#include <opm/material/common/Unused.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+BEGIN_PROPERTIES
+
+NEW_PROP_TAG(Scalar);
+NEW_PROP_TAG(Simulator);
+NEW_PROP_TAG(NumEq);
+
+//! The tolerance for the quantity which is controlled by the time step controller
+NEW_PROP_TAG(TimeStepControlTolerance);
+
+//! The maximum factor by which the time step size may grow between two time steps
+NEW_PROP_TAG(TimeStepControlMaxGrowth);
+
+END_PROPERTIES
+
+namespace Opm {
+
+/*!
+ * \brief The quantities of a successful time integration which are considered by
+ *        the time step controllers.
+ */
+template <class Scalar>
+struct TimeStepReport
+{
+    //! The size of the time step which was used for the successful attempt [s]
+    Scalar timeStepSize;
+
+    //! The number of Newton iterations of the successful attempt
+    unsigned numNewtonIterations;
+
+    //! The number of linear solver iterations of the successful attempt
+    unsigned numLinearIterations;
+
+    //! The number of failed attempts before the time integration succeeded
+    unsigned numFailures;
+
+    //! The maximum weighted relative change of the primary variables over the time step.
+    //! This is only computed for controllers which need it and zero otherwise.
+    Scalar maxRelativeChange;
+
+    //! The wall time required by the time integration including all failed attempts [s]
+    double wallTime;
+};
+
+/*!
+ * \brief Time step controller which scales the time step size by the ratio of the
+ *        target and the actual number of Newton iterations.
+ *
+ * This simply uses NewtonMethod::suggestTimeStepSize().
+ */
+template <class TypeTag>
+class NewtonIterationTimeStepController
+{
+    typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
+    typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
+
+public:
+    //! This controller does not consider the change of the primary variables
+    static constexpr bool needsRelativeChange = false;
+
+    NewtonIterationTimeStepController(Simulator& simulator)
+        : simulator_(simulator)
+    {}
+
+    /*!
+     * \brief Register all run-time parameters of the time step controller.
+     */
+    static void registerParameters()
+    {}
+
+    /*!
+     * \brief Called after a time integration has succeeded.
+     */
+    void timeStepDone(const TimeStepReport<Scalar>& report OPM_UNUSED)
+    {}
+
+    /*!
+     * \brief Returns the size of the next time step.
+     */
+    Scalar suggestTimeStepSize(Scalar oldDt) const
+    { return simulator_.model().newtonMethod().suggestTimeStepSize(oldDt); }
+
+private:
+    Simulator& simulator_;
+};
+
+/*!
+ * \brief PID time step controller for the maximum relative change of the primary
+ *        variables.
+ *
+ * The controller tries to keep the maximum change of the primary variables per
+ * time step at the value of the TimeStepControlTolerance parameter. If the change
+ * was larger, the time step size is reduced proportionally; otherwise the
+ * controller uses the errors of the last three time steps to adapt the time step
+ * size smoothly. See
+ *
+ * A.M.P. Valli, G.F. Carey, A.L.G.A. Coutinho: "Control strategies for timestep
+ * selection in finite element simulation of incompressible flows and coupled
+ * reaction-convection-diffusion processes", International Journal for Numerical
+ * Methods in Fluids, 47, pp. 201-231, 2005
+ */
+template <class TypeTag>
+class PidTimeStepController
+{
+    typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
+    typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
+
+public:
+    //! The change of the primary variables is the controlled quantity
+    static constexpr bool needsRelativeChange = true;
+
+    PidTimeStepController(Simulator& simulator)
+        : simulator_(simulator)
+        , tolerance_(EWOMS_GET_PARAM(TypeTag, Scalar, TimeStepControlTolerance))
+        , maxGrowth_(EWOMS_GET_PARAM(TypeTag, Scalar, TimeStepControlMaxGrowth))
+        , hadFailures_(false)
+    { std::fill(errors_, errors_ + 3, tolerance_); }
+
+    /*!
+     * \brief Register all run-time parameters of the time step controller.
+     */
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, TimeStepControlTolerance,
+                             "The target of the maximum relative change of the primary "
+                             "variables per time step");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, TimeStepControlMaxGrowth,
+                             "The maximum factor by which the time step size may grow "
+                             "between two time steps");
+    }
+
+    /*!
+     * \brief Called after a time integration has succeeded.
+     */
+    void timeStepDone(const TimeStepReport<Scalar>& report)
+    {
+        errors_[0] = errors_[1];
+        errors_[1] = errors_[2];
+        // avoid divisions by zero if the solution did not change at all
+        errors_[2] = std::max<Scalar>(report.maxRelativeChange, 1e-10*tolerance_);
+        hadFailures_ = report.numFailures > 0;
+    }
+
+    /*!
+     * \brief Returns the size of the next time step.
+     */
+    Scalar suggestTimeStepSize(Scalar oldDt) const
+    {
+        // the gains of the controller
+        static const Scalar kP = 0.075;
+        static const Scalar kI = 0.175;
+        static const Scalar kD = 0.01;
+
+        const Scalar eN = errors_[2];
+        const Scalar eN1 = errors_[1];
+        const Scalar eN2 = errors_[0];
+
+        Scalar factor;
+        if (eN > tolerance_)
+            factor = tolerance_/eN;
+        else
+            factor =
+                std::pow(eN1/eN, kP)
+                * std::pow(tolerance_/eN, kI)
+                * std::pow(eN1*eN1/(eN*eN2), kD);
+
+        factor = std::min(factor, maxGrowth_);
+
+        // do not increase the time step size directly after it had to be reduced
+        if (hadFailures_)
+            factor = std::min<Scalar>(factor, 1.0);
+
+        return std::max(simulator_.problem().minTimeStepSize(), oldDt*factor);
+    }
+
+private:
+    Simulator& simulator_;
+    Scalar tolerance_;
+    Scalar maxGrowth_;
+
+    // the errors of the last three time steps, the most recent one is last
+    Scalar errors_[3];
+    bool hadFailures_;
+};
+
+/*!
+ * \brief Time step controller based on an estimate of the local truncation error
+ *        of the implicit Euler scheme.
+ *
+ * The error is estimated by comparing the change of the primary variables over
+ * the last time step with the change over the time step before it. The time step
+ * size is then chosen so that the weighted relative error is at the value of the
+ * TimeStepControlTolerance parameter. Degrees of freedom for which the meaning of
+ * the primary variables changed are ignored.
+ */
+template <class TypeTag>
+class ErrorEstimateTimeStepController
+{
+    typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
+    typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
+
+    enum { numEq = GET_PROP_VALUE(TypeTag, NumEq) };
+
+public:
+    //! The error estimate is computed from the solutions themselves
+    static constexpr bool needsRelativeChange = false;
+
+    ErrorEstimateTimeStepController(Simulator& simulator)
+        : simulator_(simulator)
+        , tolerance_(EWOMS_GET_PARAM(TypeTag, Scalar, TimeStepControlTolerance))
+        , maxGrowth_(EWOMS_GET_PARAM(TypeTag, Scalar, TimeStepControlMaxGrowth))
+        , lastDt_(0.0)
+        , error_(-1.0)
+        , hadFailures_(false)
+    {}
+
+    /*!
+     * \brief Register all run-time parameters of the time step controller.
+     */
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, TimeStepControlTolerance,
+                             "The target of the estimated relative local truncation error "
+                             "per time step");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, TimeStepControlMaxGrowth,
+                             "The maximum factor by which the time step size may grow "
+                             "between two time steps");
+    }
+
+    /*!
+     * \brief Called after a time integration has succeeded.
+     *
+     * This method must be called before the model advances the time level.
+     */
+    void timeStepDone(const TimeStepReport<Scalar>& report)
+    {
+        const auto& model = simulator_.model();
+        const auto& uNew = model.solution(/*timeIdx=*/0);
+        const auto& uOld = model.solution(/*timeIdx=*/1);
+        size_t numDof = model.numGridDof();
+
+        Scalar dt = report.timeStepSize;
+        bool haveHistory = lastDelta_.size() == numDof*numEq && lastDt_ > 0.0;
+        Scalar ratio = haveHistory ? dt/lastDt_ : 0.0;
+
+        lastDelta_.resize(numDof*numEq);
+        lastDeltaValid_.resize(numDof, false);
+
+        Scalar err = 0.0;
+        for (unsigned dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+            bool deltaValid = model.primaryVarsExtrapolable(uNew[dofIdx], uOld[dofIdx]);
+            bool useDof = haveHistory && deltaValid && lastDeltaValid_[dofIdx] && model.isLocalDof(dofIdx);
+
+            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx) {
+                Scalar delta = uNew[dofIdx][pvIdx] - uOld[dofIdx][pvIdx];
+                Scalar& lastDelta = lastDelta_[dofIdx*numEq + pvIdx];
+                if (useDof) {
+                    Scalar weight = model.primaryVarWeight(dofIdx, pvIdx);
+                    err = std::max<Scalar>(err, std::abs(delta - ratio*lastDelta)*weight);
+                }
+                lastDelta = delta;
+            }
+            lastDeltaValid_[dofIdx] = deltaValid;
+        }
+
+        if (haveHistory)
+            error_ = simulator_.gridView().comm().max(err*dt/(dt + lastDt_));
+        else
+            error_ = -1.0;
+
+        lastDt_ = dt;
+        hadFailures_ = report.numFailures > 0;
+    }
+
+    /*!
+     * \brief Returns the size of the next time step.
+     */
+    Scalar suggestTimeStepSize(Scalar oldDt) const
+    {
+        // no error estimate available yet. use the number of Newton iterations
+        if (error_ < 0.0)
+            return simulator_.model().newtonMethod().suggestTimeStepSize(oldDt);
+
+        // the implicit Euler scheme is first order accurate, so its local error
+        // scales with the square of the time step size
+        static const Scalar safetyFactor = 0.9;
+        Scalar factor = safetyFactor*std::sqrt(tolerance_/std::max<Scalar>(error_, 1e-10*tolerance_));
+        factor = std::max<Scalar>(0.2, std::min(factor, maxGrowth_));
+
+        // do not increase the time step size directly after it had to be reduced
+        if (hadFailures_)
+            factor = std::min<Scalar>(factor, 1.0);
+
+        return std::max(simulator_.problem().minTimeStepSize(), oldDt*factor);
+    }
+
+private:
+    Simulator& simulator_;
+    Scalar tolerance_;
+    Scalar maxGrowth_;
+
+    // the change of the primary variables over the previous time step
+    std::vector<Scalar> lastDelta_;
+    std::vector<bool> lastDeltaValid_;
+    Scalar lastDt_;
+
+    Scalar error_;
+    bool hadFailures_;
+};
+
+} // namespace Opm
+
+#endif
@@ -49,6 +49,7 @@ public:
     {
         data_ = NULL;
         dataSize_ = 0;
+        isPersistent_ = false;
 
         setMpiDataType_();
         updateMpiDataSize_();
@@ -58,6 +59,7 @@ public:
     {
         data_ = new DataType[size];
         dataSize_ = size;
+        isPersistent_ = false;
 
         setMpiDataType_();
         updateMpiDataSize_();
@@ -66,13 +68,19 @@ public:
     MpiBuffer(const MpiBuffer&) = default;
 
     ~MpiBuffer()
-    { delete[] data_; }
+    {
+        freePersistentRequest_();
+        delete[] data_;
+    }
 
     /*!
      * \brief Set the size of the buffer
+     *
+     * This invalidates the persistent communication request of the buffer.
      */
     void resize(size_t newSize)
     {
+        freePersistentRequest_();
         delete[] data_;
         data_ = new DataType[newSize];
         dataSize_ = newSize;
@@ -123,6 +131,60 @@ public:
     }
 
 #if HAVE_MPI
+    /*!
+     * \brief Set up a persistent request which sends the buffer to a peer process.
+     *
+     * The data is not transferred until start() is called. In contrast to send(),
+     * the request can be started multiple times without being recreated.
+     */
+    void setupPersistentSend(unsigned peerRank, MPI_Comm comm, int tag)
+    {
+        freePersistentRequest_();
+        MPI_Send_init(data_,
+                      static_cast<int>(mpiDataSize_),
+                      mpiDataType_,
+                      static_cast<int>(peerRank),
+                      tag,
+                      comm,
+                      &mpiRequest_);
+        isPersistent_ = true;
+    }
+
+    /*!
+     * \brief Set up a persistent request which receives the buffer from a peer
+     *        process.
+     *
+     * The receive operation is not posted until start() is called. The buffer can
+     * be used once wait() returns.
+     */
+    void setupPersistentReceive(unsigned peerRank, MPI_Comm comm, int tag)
+    {
+        freePersistentRequest_();
+        MPI_Recv_init(data_,
+                      static_cast<int>(mpiDataSize_),
+                      mpiDataType_,
+                      static_cast<int>(peerRank),
+                      tag,
+                      comm,
+                      &mpiRequest_);
+        isPersistent_ = true;
+    }
+
+    /*!
+     * \brief Start the persistent send or receive operation of the buffer.
+     */
+    void start()
+    {
+        assert(isPersistent_);
+        MPI_Start(&mpiRequest_);
+    }
+
+    /*!
+     * \brief Returns true iff a persistent request has been set up for the buffer.
+     */
+    bool isPersistent() const
+    { return isPersistent_; }
+
     /*!
      * \brief Returns the current MPI_Request object.
      *
@@ -215,6 +277,19 @@ private:
 #endif // HAVE_MPI
     }
 
+    void freePersistentRequest_()
+    {
+#if HAVE_MPI
+        if (isPersistent_) {
+            int finalized;
+            MPI_Finalized(&finalized);
+            if (!finalized)
+                MPI_Request_free(&mpiRequest_);
+        }
+#endif // HAVE_MPI
+        isPersistent_ = false;
+    }
+
     void updateMpiDataSize_()
     {
 #if HAVE_MPI
@@ -226,6 +301,7 @@ private:
 
     DataType *data_;
     size_t dataSize_;
+    bool isPersistent_;
 #if HAVE_MPI
     size_t mpiDataSize_;
     MPI_Datatype mpiDataType_;
@@ -0,0 +1,305 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::ReproducibleSum
+ */
+#ifndef EWOMS_REPRODUCIBLE_SUM_HH
+#define EWOMS_REPRODUCIBLE_SUM_HH
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Sums floating point numbers exactly, so that the result does not depend on
+ *        the order of the summands.
+ *
+ * The summands are accumulated as a fixed-point number which covers the whole range
+ * of double precision floating point numbers (a so-called "long accumulator"). The
+ * fixed-point number is stored as 32-bit chunks which are kept in 64-bit integers to
+ * avoid the need to propagate carries for each summand. Since integer additions are
+ * associative, the result is bit-wise identical regardless of how the summands are
+ * distributed over threads and processes and of the order in which the partial sums
+ * are combined. Only the final conversion to a floating point number rounds.
+ *
+ * Adding a number costs a few integer operations and the partial sums of all
+ * processes are combined using a single collective summation of integers.
+ */
+class ReproducibleSum
+{
+    // the weight of the least significant bit of the accumulator is 2^-1074, i.e., the
+    // smallest subnormal double. the mantissa of the largest double ends at bit 2097,
+    // the remaining chunks are headroom for carries.
+    static const int chunkBits = 32;
+    static const int numChunks = 68;
+    static const int minExponent = -1074;
+
+    // the indices of the counters for non-finite summands
+    enum { nanIdx = numChunks, posInfIdx, negInfIdx, bufferSize };
+
+    // each summand adds less than 2^33 to a chunk, so carries must be propagated at
+    // least every 2^30 summands
+    static const long maxAddsBeforeNormalize = 1L << 29;
+
+    static const std::int64_t chunkMask = (std::int64_t(1) << chunkBits) - 1;
+
+public:
+    ReproducibleSum()
+    { clear(); }
+
+    /*!
+     * \brief Reset the sum to zero.
+     */
+    void clear()
+    {
+        data_.fill(0);
+        numAdds_ = 0;
+    }
+
+    /*!
+     * \brief Add a number to the sum.
+     */
+    void add(double value)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        bool negative = (bits >> 63) != 0;
+        int biasedExponent = static_cast<int>((bits >> 52) & 0x7ff);
+        std::uint64_t mantissa = bits & ((std::uint64_t(1) << 52) - 1);
+
+        if (biasedExponent == 0x7ff) {
+            // infinity or NaN
+            if (mantissa != 0)
+                ++data_[nanIdx];
+            else if (negative)
+                ++data_[negInfIdx];
+            else
+                ++data_[posInfIdx];
+            return;
+        }
+
+        if (biasedExponent == 0) {
+            // zero or subnormal number
+            if (mantissa == 0)
+                return;
+            biasedExponent = 1;
+        }
+        else
+            mantissa |= std::uint64_t(1) << 52;
+
+        // the value is mantissa*2^(biasedExponent - 1075), i.e., the least significant
+        // bit of the mantissa is bit (biasedExponent - 1) of the accumulator
+        unsigned shift = static_cast<unsigned>(biasedExponent - 1);
+        unsigned chunkIdx = shift/chunkBits;
+        unsigned bitOffset = shift%chunkBits;
+
+        std::uint64_t lowPart = (mantissa & chunkMask) << bitOffset;
+        std::uint64_t highPart = (mantissa >> chunkBits) << bitOffset;
+
+        std::int64_t c0 = static_cast<std::int64_t>(lowPart & chunkMask);
+        std::int64_t c1 = static_cast<std::int64_t>((lowPart >> chunkBits) + (highPart & chunkMask));
+        std::int64_t c2 = static_cast<std::int64_t>(highPart >> chunkBits);
+
+        if (negative) {
+            data_[chunkIdx] -= c0;
+            data_[chunkIdx + 1] -= c1;
+            data_[chunkIdx + 2] -= c2;
+        }
+        else {
+            data_[chunkIdx] += c0;
+            data_[chunkIdx + 1] += c1;
+            data_[chunkIdx + 2] += c2;
+        }
+
+        if (++numAdds_ >= maxAddsBeforeNormalize)
+            normalize_();
+    }
+
+    /*!
+     * \brief Add a number to the sum.
+     */
+    ReproducibleSum& operator+=(double value)
+    {
+        add(value);
+        return *this;
+    }
+
+    /*!
+     * \brief Add another partial sum to this one.
+     */
+    void merge(const ReproducibleSum& other)
+    {
+        ReproducibleSum tmp(other);
+        tmp.normalize_();
+        normalize_();
+
+        for (int i = 0; i < bufferSize; ++i)
+            data_[i] += tmp.data_[i];
+        normalize_();
+    }
+
+    /*!
+     * \brief Returns the sum rounded to the nearest double precision number.
+     */
+    double value() const
+    {
+        if (data_[nanIdx] > 0 || (data_[posInfIdx] > 0 && data_[negInfIdx] > 0))
+            return std::numeric_limits<double>::quiet_NaN();
+        else if (data_[posInfIdx] > 0)
+            return std::numeric_limits<double>::infinity();
+        else if (data_[negInfIdx] > 0)
+            return -std::numeric_limits<double>::infinity();
+
+        ReproducibleSum tmp(*this);
+        tmp.normalize_();
+
+        // convert the magnitude of the fixed-point number. since the representation is
+        // unique after normalization, this is deterministic.
+        double sign = 1.0;
+        if (tmp.data_[numChunks - 1] < 0) {
+            sign = -1.0;
+            for (int i = 0; i < numChunks; ++i)
+                tmp.data_[i] = -tmp.data_[i];
+            tmp.normalize_();
+        }
+
+        // find the most significant non-zero bit. since the least significant bit of the
+        // accumulator corresponds to the smallest subnormal double, the least
+        // significant bit of the result is at position max(msbPos - 52, 0), regardless
+        // of whether the result is a normal or a subnormal number.
+        int topChunkIdx = numChunks - 1;
+        while (topChunkIdx >= 0 && tmp.data_[topChunkIdx] == 0)
+            --topChunkIdx;
+        if (topChunkIdx < 0)
+            return 0.0;
+
+        int msbPos = topChunkIdx*chunkBits;
+        for (std::int64_t topChunk = tmp.data_[topChunkIdx] >> 1; topChunk != 0; topChunk >>= 1)
+            ++msbPos;
+
+        // the magnitude is at least 2^1024
+        if (msbPos + minExponent >= std::numeric_limits<double>::max_exponent)
+            return sign*std::numeric_limits<double>::infinity();
+
+        int lsbPos = std::max(msbPos - (std::numeric_limits<double>::digits - 1), 0);
+        std::uint64_t mantissa = 0;
+        for (int pos = msbPos; pos >= lsbPos; --pos)
+            mantissa = (mantissa << 1) | tmp.bit_(pos);
+
+        // round to nearest, ties to even, using the bit below the mantissa and a
+        // sticky bit for all bits below that one
+        if (lsbPos > 0 && tmp.bit_(lsbPos - 1)) {
+            bool sticky = false;
+            int stickyPos = lsbPos - 1;
+            int stickyChunkIdx = stickyPos/chunkBits;
+            std::int64_t stickyMask = (std::int64_t(1) << (stickyPos%chunkBits)) - 1;
+            if (tmp.data_[stickyChunkIdx] & stickyMask)
+                sticky = true;
+            for (int i = 0; i < stickyChunkIdx && !sticky; ++i)
+                sticky = tmp.data_[i] != 0;
+
+            if (sticky || (mantissa & 1))
+                ++mantissa;
+        }
+
+        // the mantissa has at most 54 bits and the last one is zero if it has 54, so it
+        // is exactly representable. std::ldexp() is thus exact unless it overflows.
+        double result = std::ldexp(static_cast<double>(mantissa), lsbPos + minExponent);
+
+        return sign*result;
+    }
+
+    /*!
+     * \brief Sum up partial sums over all processes of a collective communication.
+     *
+     * After this method has been called, all processes hold the global sums. The sums
+     * of all objects are combined using a single collective operation.
+     */
+    template <class CollectiveCommunication>
+    static void sumOverProcesses(ReproducibleSum* sums,
+                                 size_t numSums,
+                                 const CollectiveCommunication& comm)
+    {
+        if (comm.size() <= 1)
+            return;
+
+        std::vector<std::int64_t> buffer(numSums*bufferSize);
+        for (size_t sumIdx = 0; sumIdx < numSums; ++sumIdx) {
+            // after normalization, all chunks are smaller than 2^32 in magnitude, so
+            // the collective summation cannot overflow
+            sums[sumIdx].normalize_();
+            std::copy(sums[sumIdx].data_.begin(),
+                      sums[sumIdx].data_.end(),
+                      buffer.begin() + sumIdx*bufferSize);
+        }
+
+        comm.sum(buffer.data(), static_cast<int>(buffer.size()));
+
+        for (size_t sumIdx = 0; sumIdx < numSums; ++sumIdx) {
+            std::copy(buffer.begin() + sumIdx*bufferSize,
+                      buffer.begin() + (sumIdx + 1)*bufferSize,
+                      sums[sumIdx].data_.begin());
+            sums[sumIdx].normalize_();
+        }
+    }
+
+    /*!
+     * \brief Sum up a partial sum over all processes of a collective communication.
+     */
+    template <class CollectiveCommunication>
+    void sumOverProcesses(const CollectiveCommunication& comm)
+    { sumOverProcesses(this, 1, comm); }
+
+private:
+    // returns a bit of the normalized accumulator
+    std::uint64_t bit_(int pos) const
+    { return static_cast<std::uint64_t>(data_[pos/chunkBits] >> (pos%chunkBits)) & 1; }
+
+    // propagate the carries, so that all chunks except the most significant one are
+    // within [0, 2^32). this representation of the fixed-point number is unique.
+    void normalize_()
+    {
+        for (int i = 0; i < numChunks - 1; ++i) {
+            // arithmetic right shift, i.e., the carry is rounded towards -infinity
+            std::int64_t carry = data_[i] >> chunkBits;
+            data_[i] -= carry*(std::int64_t(1) << chunkBits);
+            data_[i + 1] += carry;
+        }
+        numAdds_ = 0;
+    }
+
+    std::array<std::int64_t, bufferSize> data_;
+    long numAdds_;
+};
+
+} // namespace Opm
+
+#endif
@@ -46,12 +46,16 @@
 #include <opm/models/io/vtkcompositionmodule.hh>
 #include <opm/models/io/vtkenergymodule.hh>
 #include <opm/models/io/vtkdiffusionmodule.hh>
+#include <opm/models/parallel/threadedentityiterator.hh>
 
 #include <opm/material/fluidmatrixinteractions/NullMaterial.hpp>
 #include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
 #include <opm/material/common/Exceptions.hpp>
 
+#include <atomic>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -323,6 +327,13 @@ public:
         return oss.str();
     }
 
+    /*!
+     * \copydoc FvBaseDiscretization::primaryVarsExtrapolable
+     */
+    bool primaryVarsExtrapolable(const PrimaryVariables& priVars1,
+                                 const PrimaryVariables& priVars2) const
+    { return priVars1.phasePresence() == priVars2.phasePresence(); }
+
     /*!
      * \copydoc FvBaseDiscretization::updateFailed
      */
@@ -465,59 +476,78 @@ public:
     {
         numSwitched_ = 0;
 
-        int succeeded;
-        try {
-            std::vector<bool> visited(this->numGridDof(), false);
-            ElementContext elemCtx(this->simulator_);
-
-            ElementIterator elemIt = this->gridView_.template begin<0>();
-            ElementIterator elemEndIt = this->gridView_.template end<0>();
-            for (; elemIt != elemEndIt; ++elemIt) {
-                const Element& elem = *elemIt;
-                if (elem.partitionType() != Dune::InteriorEntity)
-                    continue;
-                elemCtx.updateStencil(elem);
-
-                size_t numLocalDof = elemCtx.stencil(/*timeIdx=*/0).numPrimaryDof();
-                for (unsigned dofIdx = 0; dofIdx < numLocalDof; ++dofIdx) {
-                    unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
-
-                    if (visited[globalIdx])
+        // the degrees of freedom which have already been visited. since vertex
+        // centered discretizations share degrees of freedom between elements that
+        // may be handled by different threads, a DOF gets claimed atomically.
+        size_t numGridDof = this->numGridDof();
+        std::unique_ptr<std::atomic<bool>[]> visited(new std::atomic<bool>[numGridDof]);
+        for (size_t dofIdx = 0; dofIdx < numGridDof; ++dofIdx)
+            visited[dofIdx].store(false, std::memory_order_relaxed);
+
+        int succeeded = 1;
+        std::mutex mutex;
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(this->gridView_);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            // the switch of a degree of freedom only depends on its own primary
+            // variables, so the result does not depend on the number of threads
+            unsigned threadNumSwitched = 0;
+            try {
+                ElementContext elemCtx(this->simulator_);
+                ElementIterator elemIt = threadedElemIt.beginParallel();
+                for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                    const Element& elem = *elemIt;
+                    if (elem.partitionType() != Dune::InteriorEntity)
                         continue;
-                    visited[globalIdx] = true;
-
-                    // compute the intensive quantities of the current degree of freedom
-                    auto& priVars = this->solution(/*timeIdx=*/0)[globalIdx];
-                    elemCtx.updateIntensiveQuantities(priVars, dofIdx, /*timeIdx=*/0);
-                    const IntensiveQuantities& intQuants = elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0);
-
-                    // evaluate primary variable switch
-                    short oldPhasePresence = priVars.phasePresence();
-
-                    // set the primary variables and the new phase state
-                    // from the current fluid state
-                    priVars.assignNaive(intQuants.fluidState());
-
-                    if (oldPhasePresence != priVars.phasePresence()) {
-                        if (verbosity_ > 1)
-                            printSwitchedPhases_(elemCtx,
-                                                 dofIdx,
-                                                 intQuants.fluidState(),
-                                                 oldPhasePresence,
-                                                 priVars);
-                        ++numSwitched_;
+                    elemCtx.updateStencil(elem);
+
+                    size_t numLocalDof = elemCtx.stencil(/*timeIdx=*/0).numPrimaryDof();
+                    for (unsigned dofIdx = 0; dofIdx < numLocalDof; ++dofIdx) {
+                        unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+
+                        if (visited[globalIdx].exchange(true, std::memory_order_relaxed))
+                            continue;
+
+                        // compute the intensive quantities of the current degree of freedom
+                        auto& priVars = this->solution(/*timeIdx=*/0)[globalIdx];
+                        elemCtx.updateIntensiveQuantities(priVars, dofIdx, /*timeIdx=*/0);
+                        const IntensiveQuantities& intQuants = elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0);
+
+                        // evaluate primary variable switch
+                        short oldPhasePresence = priVars.phasePresence();
+
+                        // set the primary variables and the new phase state
+                        // from the current fluid state
+                        priVars.assignNaive(intQuants.fluidState());
+
+                        if (oldPhasePresence != priVars.phasePresence()) {
+                            if (verbosity_ > 1) {
+                                std::lock_guard<std::mutex> lock(mutex);
+                                printSwitchedPhases_(elemCtx,
+                                                     dofIdx,
+                                                     intQuants.fluidState(),
+                                                     oldPhasePresence,
+                                                     priVars);
+                            }
+                            ++threadNumSwitched;
+                        }
                     }
                 }
             }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                std::cout << "rank " << this->simulator_.gridView().comm().rank()
+                          << " caught an exception during primary variable switching"
+                          << "\n"  << std::flush;
+                succeeded = 0;
+                threadedElemIt.setFinished();
+            }
 
-            succeeded = 1;
-        }
-        catch (...)
-        {
-            std::cout << "rank " << this->simulator_.gridView().comm().rank()
-                      << " caught an exception during primary variable switching"
-                      << "\n"  << std::flush;
-            succeeded = 0;
+            std::lock_guard<std::mutex> lock(mutex);
+            numSwitched_ += threadNumSwitched;
         }
         succeeded = this->simulator_.gridView().comm().min(succeeded);
 
@@ -46,6 +46,10 @@
 #include <type_traits>
 #include <cassert>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace Opm {
 
 namespace detail {
@@ -221,6 +225,74 @@ inline bool operator!=(const aligned_allocator<T1,
 {
     return false;
 }
+
+/*!
+ * \brief Touch the memory pages of a freshly allocated block of memory in parallel.
+ *
+ * On NUMA machines, the operating system usually places a memory page on the NUMA
+ * node of the thread which writes to it first. If the pages of a large array are
+ * touched by the OpenMP threads using a static schedule, each thread's share of the
+ * array is thus located on its own node, even if the objects in the array are
+ * subsequently constructed by a single thread.
+ *
+ * Small blocks and blocks which are allocated within parallel regions are ignored.
+ */
+inline void first_touch(void* ptr, std::size_t size) noexcept
+{
+#ifdef _OPENMP
+    static const std::size_t pageSize = 4096;
+    static const std::size_t minSize = 64*pageSize;
+
+    if (!ptr || size < minSize || omp_in_parallel() || omp_get_max_threads() < 2)
+        return;
+
+    char* bytes = static_cast<char*>(ptr);
+    long numPages = static_cast<long>((size + pageSize - 1)/pageSize);
+#pragma omp parallel for schedule(static)
+    for (long pageIdx = 0; pageIdx < numPages; ++pageIdx)
+        bytes[pageIdx*pageSize] = 0;
+#else
+    (void)ptr;
+    (void)size;
+#endif
+}
+
+/*!
+ * \brief An aligned allocator which distributes the memory of large allocations over
+ *        the NUMA nodes of the OpenMP threads.
+ *
+ * This is intended for the large per degree of freedom arrays, which are accessed by
+ * all threads during the linearization. See first_touch().
+ */
+template<class T, std::size_t Alignment>
+class first_touch_allocator : public aligned_allocator<T, Alignment> {
+    typedef aligned_allocator<T, Alignment> ParentType;
+
+public:
+    typedef typename ParentType::pointer pointer;
+    typedef typename ParentType::size_type size_type;
+    typedef typename ParentType::const_void_pointer const_void_pointer;
+
+    template<class U>
+    struct rebind {
+        typedef first_touch_allocator<U, Alignment> other;
+    };
+
+    first_touch_allocator()
+        noexcept = default;
+
+    template<class U>
+    first_touch_allocator(const first_touch_allocator<U,
+                          Alignment>&) noexcept {
+    }
+
+    pointer allocate(size_type size,
+                     const_void_pointer hint = 0) {
+        pointer p = ParentType::allocate(size, hint);
+        first_touch(p, sizeof(T) * size);
+        return p;
+    }
+};
 }
 
 #endif
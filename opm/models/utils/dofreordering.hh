@@ -0,0 +1,272 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Algorithms which compute cache friendly orderings of the degrees of freedom.
+ */
+#ifndef EWOMS_DOF_REORDERING_HH
+#define EWOMS_DOF_REORDERING_HH
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief The orderings of the degrees of freedom which are supported by
+ *        Opm::ReorderedMapper.
+ */
+enum DofOrdering {
+    //! use the indices of the grid's index set
+    naturalDofOrdering,
+
+    //! use the reverse Cuthill-McKee ordering of the connectivity graph
+    rcmDofOrdering,
+
+    //! sort the degrees of freedom along a Hilbert space-filling curve
+    hilbertDofOrdering
+};
+
+/*!
+ * \brief Convert the value of the DofOrdering parameter to a DofOrdering.
+ */
+inline DofOrdering dofOrderingFromString(const std::string& name)
+{
+    if (name == "natural")
+        return naturalDofOrdering;
+    else if (name == "rcm")
+        return rcmDofOrdering;
+    else if (name == "hilbert")
+        return hilbertDofOrdering;
+
+    throw std::invalid_argument("Unknown ordering of the degrees of freedom '"+name+"'. "
+                                "Valid values are 'natural', 'rcm' and 'hilbert'");
+}
+
+/*!
+ * \brief Compute the reverse Cuthill-McKee ordering of an undirected graph.
+ *
+ * The graph is given in compressed row format, i.e., the neighbors of vertex i are
+ * neighbors[rowOffsets[i]] ... neighbors[rowOffsets[i + 1] - 1]. The graph must be
+ * symmetric. Each connected component is started at a pseudo-peripheral vertex which
+ * is determined using the heuristic of George and Liu. The result is deterministic,
+ * i.e., it only depends on the graph.
+ *
+ * \return The vertices in their new order, i.e., the i-th entry is the old index of the
+ *         vertex which gets the new index i.
+ */
+template <class Index>
+std::vector<Index> reverseCuthillMcKeeOrder(const std::vector<size_t>& rowOffsets,
+                                            const std::vector<Index>& neighbors)
+{
+    const size_t numVertices = rowOffsets.empty() ? 0 : rowOffsets.size() - 1;
+    auto degree = [&rowOffsets](size_t vertexIdx) -> size_t
+                  { return rowOffsets[vertexIdx + 1] - rowOffsets[vertexIdx]; };
+    auto lessDegree = [&degree](Index a, Index b) -> bool
+                      { return degree(a) < degree(b) || (degree(a) == degree(b) && a < b); };
+
+    // the vertices sorted by their degree. the start vertex of each connected component
+    // is searched for starting with the first unnumbered vertex of minimum degree.
+    std::vector<Index> byDegree(numVertices);
+    for (size_t vertexIdx = 0; vertexIdx < numVertices; ++vertexIdx)
+        byDegree[vertexIdx] = static_cast<Index>(vertexIdx);
+    std::sort(byDegree.begin(), byDegree.end(), lessDegree);
+
+    std::vector<bool> isNumbered(numVertices, false);
+    std::vector<int> level(numVertices, -1);
+    std::vector<Index> order;
+    order.reserve(numVertices);
+
+    // breadth first search from a root vertex within the current component. this
+    // returns the depth of the rooted level structure and the vertices of its last
+    // level.
+    std::vector<Index> visited;
+    auto levelStructure = [&](Index root, std::vector<Index>& lastLevel) -> int
+    {
+        visited.clear();
+        visited.push_back(root);
+        level[root] = 0;
+        int depth = 0;
+        for (size_t i = 0; i < visited.size(); ++i) {
+            Index vertexIdx = visited[i];
+            depth = level[vertexIdx];
+            for (size_t j = rowOffsets[vertexIdx]; j < rowOffsets[vertexIdx + 1]; ++j) {
+                Index neighborIdx = neighbors[j];
+                if (level[neighborIdx] < 0 && !isNumbered[neighborIdx]) {
+                    level[neighborIdx] = depth + 1;
+                    visited.push_back(neighborIdx);
+                }
+            }
+        }
+
+        lastLevel.clear();
+        for (Index vertexIdx : visited) {
+            if (level[vertexIdx] == depth)
+                lastLevel.push_back(vertexIdx);
+            level[vertexIdx] = -1;
+        }
+        return depth;
+    };
+
+    std::vector<Index> lastLevel;
+    std::vector<Index> candidateLastLevel;
+    std::vector<Index> unnumberedNeighbors;
+    size_t byDegreeIdx = 0;
+    while (order.size() < numVertices) {
+        while (isNumbered[byDegree[byDegreeIdx]])
+            ++byDegreeIdx;
+        Index root = byDegree[byDegreeIdx];
+
+        // find a pseudo-peripheral vertex, i.e., one which is approximately as far
+        // away as possible from all other vertices of its component
+        int depth = levelStructure(root, lastLevel);
+        while (true) {
+            Index candidate = *std::min_element(lastLevel.begin(), lastLevel.end(), lessDegree);
+            int candidateDepth = levelStructure(candidate, candidateLastLevel);
+            if (candidateDepth <= depth)
+                break;
+
+            root = candidate;
+            depth = candidateDepth;
+            std::swap(lastLevel, candidateLastLevel);
+        }
+
+        // number the vertices of the component in Cuthill-McKee order, i.e., breadth
+        // first with the neighbors of each vertex sorted by their degree
+        size_t firstIdx = order.size();
+        order.push_back(root);
+        isNumbered[root] = true;
+        for (size_t i = firstIdx; i < order.size(); ++i) {
+            Index vertexIdx = order[i];
+            unnumberedNeighbors.clear();
+            for (size_t j = rowOffsets[vertexIdx]; j < rowOffsets[vertexIdx + 1]; ++j) {
+                Index neighborIdx = neighbors[j];
+                if (!isNumbered[neighborIdx]) {
+                    isNumbered[neighborIdx] = true;
+                    unnumberedNeighbors.push_back(neighborIdx);
+                }
+            }
+            std::sort(unnumberedNeighbors.begin(), unnumberedNeighbors.end(), lessDegree);
+            order.insert(order.end(), unnumberedNeighbors.begin(), unnumberedNeighbors.end());
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+/*!
+ * \brief Sort a set of points along a Hilbert space-filling curve.
+ *
+ * The bounding box of the points is discretized using 2^32 (1D and 2D) or 2^21 (3D)
+ * intervals per direction and the points are sorted by the position of their interval
+ * on the Hilbert curve. The index of the cells on the curve is computed using the
+ * algorithm of J. Skilling: "Programming the Hilbert curve", AIP Conference
+ * Proceedings 707, 2004. Points which fall into the same interval keep their relative
+ * order.
+ *
+ * \return The points in their new order, i.e., the i-th entry is the old index of the
+ *         point which gets the new index i.
+ */
+template <class Index, int dim, class Point>
+std::vector<Index> hilbertCurveOrder(const std::vector<Point>& points)
+{
+    static_assert(1 <= dim && dim <= 3, "Hilbert curves are only implemented for 1 to 3 dimensions");
+    static const int numBits = (dim == 3) ? 21 : 32;
+
+    const size_t numPoints = points.size();
+
+    double minCoord[dim];
+    double maxCoord[dim];
+    for (int axisIdx = 0; axisIdx < dim; ++axisIdx) {
+        minCoord[axisIdx] = std::numeric_limits<double>::max();
+        maxCoord[axisIdx] = -std::numeric_limits<double>::max();
+    }
+    for (const auto& point : points) {
+        for (int axisIdx = 0; axisIdx < dim; ++axisIdx) {
+            minCoord[axisIdx] = std::min<double>(minCoord[axisIdx], point[axisIdx]);
+            maxCoord[axisIdx] = std::max<double>(maxCoord[axisIdx], point[axisIdx]);
+        }
+    }
+
+    const double maxCellIdx = static_cast<double>((std::uint64_t(1) << numBits) - 1);
+    std::vector<std::pair<std::uint64_t, Index> > keys(numPoints);
+    for (size_t pointIdx = 0; pointIdx < numPoints; ++pointIdx) {
+        std::uint32_t x[dim];
+        for (int axisIdx = 0; axisIdx < dim; ++axisIdx) {
+            double extent = maxCoord[axisIdx] - minCoord[axisIdx];
+            double relPos = (extent > 0.0) ? (points[pointIdx][axisIdx] - minCoord[axisIdx])/extent : 0.0;
+            x[axisIdx] = static_cast<std::uint32_t>(relPos*maxCellIdx);
+        }
+
+        // transform the cell coordinates to the "transposed" Hilbert index
+        const std::uint32_t highestBit = std::uint32_t(1) << (numBits - 1);
+        for (std::uint32_t q = highestBit; q > 1; q >>= 1) {
+            std::uint32_t p = q - 1;
+            for (int axisIdx = 0; axisIdx < dim; ++axisIdx) {
+                if (x[axisIdx] & q)
+                    x[0] ^= p;
+                else {
+                    std::uint32_t t = (x[0] ^ x[axisIdx]) & p;
+                    x[0] ^= t;
+                    x[axisIdx] ^= t;
+                }
+            }
+        }
+
+        for (int axisIdx = 1; axisIdx < dim; ++axisIdx)
+            x[axisIdx] ^= x[axisIdx - 1];
+
+        std::uint32_t t = 0;
+        for (std::uint32_t q = highestBit; q > 1; q >>= 1)
+            if (x[dim - 1] & q)
+                t ^= q - 1;
+        for (int axisIdx = 0; axisIdx < dim; ++axisIdx)
+            x[axisIdx] ^= t;
+
+        // interleave the bits of the transposed index
+        std::uint64_t key = 0;
+        for (int bitIdx = numBits - 1; bitIdx >= 0; --bitIdx)
+            for (int axisIdx = 0; axisIdx < dim; ++axisIdx)
+                key = (key << 1) | ((x[axisIdx] >> bitIdx) & 1);
+
+        keys[pointIdx] = std::make_pair(key, static_cast<Index>(pointIdx));
+    }
+
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<Index> order(numPoints);
+    for (size_t i = 0; i < numPoints; ++i)
+        order[i] = keys[i].second;
+    return order;
+}
+
+} // namespace Opm
+
+#endif
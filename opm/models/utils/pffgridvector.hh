@@ -65,11 +65,12 @@ public:
         unsigned numLocalDofs = computeNumLocalDofs_();
 
         elemData_.resize(numElements);
+        elemNumDof_.resize(numElements);
         data_.resize(numLocalDofs);
 
         // update the pointers for the element data: for this, we need to loop over the
         // whole grid and update a stencil for each element
-        Data *curElemDataPtr = &data_[0];
+        Data *curElemDataPtr = data_.data();
         Stencil stencil(gridView_, dofMapper_);
         auto elemIt = gridView_.template begin</*codim=*/0>();
         const auto& elemEndIt = gridView_.template end</*codim=*/0>();
@@ -81,6 +82,7 @@ public:
 
             stencil.update(elem);
             unsigned numDof = stencil.numDof();
+            elemNumDof_[elemIdx] = numDof;
             for (unsigned localDofIdx = 0; localDofIdx < numDof; ++ localDofIdx)
                 distFn(curElemDataPtr[localDofIdx], stencil, localDofIdx);
 
@@ -96,7 +98,7 @@ public:
 
         // we use 0 as the temporal locality, because it is reasonable to assume that an
         // entry will only be accessed once.
-        Opm::prefetch</*temporalLocality=*/0>(elemData_[elemIdx]);
+        Opm::prefetch</*temporalLocality=*/0>(*elemData_[elemIdx], elemNumDof_[elemIdx]);
     }
 
     const Data& get(const Element& elem, unsigned localDofIdx) const
@@ -127,6 +129,7 @@ private:
     const DofMapper& dofMapper_;
     std::vector<Data> data_;
     std::vector<Data*> elemData_;
+    std::vector<unsigned> elemNumDof_;
 };
 
 } // namespace Opm
@@ -0,0 +1,373 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::ReorderedMapper
+ */
+#ifndef EWOMS_REORDERED_MAPPER_HH
+#define EWOMS_REORDERED_MAPPER_HH
+
+#include <opm/models/utils/dofreordering.hh>
+
+#include <dune/grid/common/mcmgmapper.hh>
+#include <dune/geometry/type.hh>
+#include <dune/common/fvector.hh>
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief A permutation of the elements or the vertices of a grid view.
+ *
+ * The permutation maps the indices of Dune::MultipleCodimMultipleGeomTypeMapper to the
+ * ones given by an ordering of the entities and vice versa. Computing it requires to
+ * traverse the grid, so it is usually computed once by the vanguard and shared by all
+ * mappers of the grid view, see Opm::ReorderedMapper.
+ */
+template <class GridView>
+class EntityPermutation
+{
+    typedef Dune::MultipleCodimMultipleGeomTypeMapper<GridView> NaturalMapper;
+
+    enum { dim = GridView::dimension };
+    enum { dimWorld = GridView::dimensionworld };
+
+public:
+    typedef typename NaturalMapper::Index Index;
+
+    /*!
+     * \brief Compute the permutation of the entities of a given codimension.
+     *
+     * \param gridView The grid view whose entities are permuted
+     * \param codim The codimension of the entities, i.e., 0 for elements and
+     *              GridView::dimension for vertices
+     * \param ordering The ordering of the entities
+     */
+    EntityPermutation(const GridView& gridView, int codim, DofOrdering ordering)
+        : codim_(codim)
+        , ordering_(ordering)
+    {
+        if (codim_ != 0 && codim_ != dim)
+            throw std::invalid_argument("Only the elements or the vertices of a grid can "
+                                        "be reordered");
+
+        if (ordering_ == naturalDofOrdering)
+            return;
+
+        if (codim_ == 0) {
+            NaturalMapper mapper(gridView, Dune::mcmgElementLayout());
+            naturalIndex_ = computeOrder_</*codim=*/0>(gridView, mapper);
+        }
+        else {
+            NaturalMapper mapper(gridView, Dune::mcmgVertexLayout());
+            naturalIndex_ = computeOrder_<dim>(gridView, mapper);
+        }
+
+        newIndex_.resize(naturalIndex_.size());
+        for (size_t idx = 0; idx < naturalIndex_.size(); ++idx)
+            newIndex_[naturalIndex_[idx]] = static_cast<Index>(idx);
+    }
+
+    /*!
+     * \brief Returns the codimension of the permuted entities.
+     */
+    int codim() const
+    { return codim_; }
+
+    /*!
+     * \brief Returns the ordering of the entities.
+     */
+    DofOrdering ordering() const
+    { return ordering_; }
+
+    /*!
+     * \brief Returns true if the permutation does not change any index.
+     */
+    bool isIdentity() const
+    { return newIndex_.empty(); }
+
+    /*!
+     * \brief Returns the number of permuted entities.
+     *
+     * This is zero if the permutation is the identity.
+     */
+    size_t size() const
+    { return newIndex_.size(); }
+
+    /*!
+     * \brief Returns the permuted index for an index of the grid's index set.
+     */
+    Index newIndex(Index naturalIdx) const
+    { return isIdentity() ? naturalIdx : newIndex_[naturalIdx]; }
+
+    /*!
+     * \brief Returns the index of the grid's index set for a permuted index.
+     */
+    Index naturalIndex(Index idx) const
+    { return isIdentity() ? idx : naturalIndex_[idx]; }
+
+private:
+    template <int entityCodim>
+    std::vector<Index> computeOrder_(const GridView& gridView, const NaturalMapper& mapper) const
+    {
+        size_t numEntities = static_cast<size_t>(mapper.size());
+        if (numEntities == 0)
+            return std::vector<Index>();
+
+        if (ordering_ == hilbertDofOrdering) {
+            std::vector<Dune::FieldVector<typename GridView::ctype, dimWorld> > points(numEntities);
+            auto it = gridView.template begin<entityCodim>();
+            const auto& endIt = gridView.template end<entityCodim>();
+            for (; it != endIt; ++it)
+                points[mapper.index(*it)] = it->geometry().center();
+
+            return hilbertCurveOrder<Index, dimWorld>(points);
+        }
+
+        // reverse Cuthill-McKee: the connectivity graph of the degrees of freedom is
+        // given by the neighboring elements for cell centered discretizations and by
+        // the vertices which share an element for vertex centered ones.
+        std::vector<std::pair<Index, Index> > edges;
+        auto elemIt = gridView.template begin</*codim=*/0>();
+        const auto& elemEndIt = gridView.template end</*codim=*/0>();
+        for (; elemIt != elemEndIt; ++elemIt) {
+            const auto& elem = *elemIt;
+            if (entityCodim == 0) {
+                Index elemIdx = mapper.index(elem);
+                auto isIt = gridView.ibegin(elem);
+                const auto& isEndIt = gridView.iend(elem);
+                for (; isIt != isEndIt; ++isIt) {
+                    if (isIt->neighbor())
+                        edges.emplace_back(elemIdx, mapper.index(isIt->outside()));
+                }
+            }
+            else {
+                unsigned numVertices = elem.subEntities(dim);
+                for (unsigned i = 0; i < numVertices; ++i) {
+                    Index vertIdx = mapper.subIndex(elem, static_cast<int>(i), dim);
+                    for (unsigned j = 0; j < numVertices; ++j)
+                        if (i != j)
+                            edges.emplace_back(vertIdx,
+                                               mapper.subIndex(elem, static_cast<int>(j), dim));
+                }
+            }
+        }
+
+        // the connectivity in compressed row format. the graph of intersections is
+        // symmetric, but the same pair of entities may occur more than once.
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        std::vector<size_t> rowOffsets(numEntities + 1, 0);
+        std::vector<Index> neighbors(edges.size());
+        for (size_t edgeIdx = 0; edgeIdx < edges.size(); ++edgeIdx) {
+            ++rowOffsets[edges[edgeIdx].first + 1];
+            neighbors[edgeIdx] = edges[edgeIdx].second;
+        }
+        for (size_t idx = 0; idx < numEntities; ++idx)
+            rowOffsets[idx + 1] += rowOffsets[idx];
+
+        return reverseCuthillMcKeeOrder(rowOffsets, neighbors);
+    }
+
+    int codim_;
+    DofOrdering ordering_;
+
+    // the new index of each entity of the grid's index set and vice versa. both are
+    // empty if the entities are not reordered.
+    std::vector<Index> newIndex_;
+    std::vector<Index> naturalIndex_;
+};
+
+/*!
+ * \brief A mapper for the elements or the vertices of a grid view which optionally
+ *        renumbers the entities to improve the memory locality.
+ *
+ * The indices are those of Dune::MultipleCodimMultipleGeomTypeMapper, permuted by the
+ * Opm::EntityPermutation which is specified at construction time. The permutation is
+ * shared with the other mappers of the grid view, so it is only computed once.
+ *
+ * Code which is not aware of the permutation, e.g., the output writers, expects data
+ * in the order of the grid's index set. Such data can be converted using
+ * restoreNaturalOrder().
+ */
+template <class GridView>
+class ReorderedMapper
+{
+    typedef Dune::MultipleCodimMultipleGeomTypeMapper<GridView> NaturalMapper;
+    typedef typename GridView::template Codim<0>::Entity Element;
+
+    enum { dim = GridView::dimension };
+
+public:
+    typedef typename NaturalMapper::Index Index;
+    typedef Opm::EntityPermutation<GridView> Permutation;
+
+    /*!
+     * \brief Create a mapper for a grid view.
+     *
+     * \param gridView The grid view whose entities are mapped
+     * \param layout The layout which specifies the mapped entities
+     * \param permutation The permutation of the mapped entities. If this is a null
+     *                    pointer, the indices of the grid's index set are used.
+     */
+    ReorderedMapper(const GridView& gridView,
+                    const Dune::MCMGLayout& layout,
+                    std::shared_ptr<const Permutation> permutation = nullptr)
+        : gridView_(gridView)
+        , naturalMapper_(gridView_, layout)
+    {
+        if (permutation && !permutation->isIdentity()) {
+            // find out whether the layout maps the elements or the vertices of the grid.
+            // only these can be reordered.
+            int codim = -1;
+            auto elemIt = gridView_.template begin</*codim=*/0>();
+            if (elemIt != gridView_.template end</*codim=*/0>()) {
+                bool mapsElements = static_cast<bool>(layout(elemIt->type(), dim));
+                bool mapsVertices = static_cast<bool>(layout(Dune::GeometryTypes::vertex, dim));
+                if (mapsElements && !mapsVertices)
+                    codim = 0;
+                else if (mapsVertices && !mapsElements)
+                    codim = dim;
+            }
+
+            if (codim != permutation->codim() || permutation->size() != size())
+                throw std::invalid_argument("The permutation does not match the entities "
+                                            "of the mapper");
+
+            permutation_ = permutation;
+        }
+    }
+
+    /*!
+     * \brief Returns the ordering of the entities.
+     */
+    DofOrdering ordering() const
+    { return isReordered() ? permutation_->ordering() : naturalDofOrdering; }
+
+    /*!
+     * \brief Returns true if the indices differ from the ones of the grid's index set.
+     */
+    bool isReordered() const
+    { return static_cast<bool>(permutation_); }
+
+    /*!
+     * \brief Returns the index of an entity.
+     */
+    template <class EntityType>
+    Index index(const EntityType& e) const
+    { return permute_(naturalMapper_.index(e)); }
+
+    /*!
+     * \brief Returns the index of a sub-entity of an element.
+     */
+    Index subIndex(const Element& e, int i, unsigned codim) const
+    { return permute_(naturalMapper_.subIndex(e, i, codim)); }
+
+    /*!
+     * \brief Returns the number of mapped entities.
+     */
+    size_t size() const
+    { return static_cast<size_t>(naturalMapper_.size()); }
+
+    /*!
+     * \brief Returns true if an entity is mapped and its index.
+     */
+    template <class EntityType>
+    bool contains(const EntityType& e, Index& result) const
+    {
+        bool isContained = naturalMapper_.contains(e, result);
+        if (isContained)
+            result = permute_(result);
+        return isContained;
+    }
+
+    /*!
+     * \brief Returns true if a sub-entity of an element is mapped and its index.
+     */
+    bool contains(const Element& e, int i, int cc, Index& result) const
+    {
+        bool isContained = naturalMapper_.contains(e, i, cc, result);
+        if (isContained)
+            result = permute_(result);
+        return isContained;
+    }
+
+    /*!
+     * \brief Recompute the indices after the grid has been changed.
+     *
+     * The permutation stems from the grid before the change, so this is only possible
+     * if the entities are not reordered.
+     */
+    void update()
+    {
+        if (isReordered())
+            throw std::logic_error("Mappers which reorder the entities of a grid cannot "
+                                   "be updated after the grid has been changed");
+
+        naturalMapper_.update();
+    }
+
+    /*!
+     * \brief Returns the index of the grid's index set for a mapped index.
+     */
+    Index naturalIndex(Index idx) const
+    { return isReordered() ? permutation_->naturalIndex(idx) : idx; }
+
+    /*!
+     * \brief Bring a container which is indexed by the indices of this mapper into the
+     *        order of the grid's index set.
+     */
+    template <class Container>
+    void restoreNaturalOrder(Container& data) const
+    {
+        if (!isReordered())
+            return;
+
+        assert(data.size() == size());
+        Container tmp(data);
+        for (size_t idx = 0; idx < size(); ++idx)
+            data[permutation_->naturalIndex(static_cast<Index>(idx))] = tmp[idx];
+    }
+
+private:
+    Index permute_(Index naturalIdx) const
+    { return isReordered() ? permutation_->newIndex(naturalIdx) : naturalIdx; }
+
+    GridView gridView_;
+    NaturalMapper naturalMapper_;
+
+    // the permutation of the entities. this is a null pointer if the entities are
+    // not reordered.
+    std::shared_ptr<const Permutation> permutation_;
+};
+
+} // namespace Opm
+
+#endif
@@ -184,28 +184,27 @@ public:
     }
 
 private:
-    // update the weighted absolute residual
+    // update the absolute residual and check for stagnation. both are determined by a
+    // single sweep and a single collective communication.
     void updateErrors_(const Vector& curSol OPM_UNUSED, const Vector& changeIndicator,  const Vector& curResid)
     {
+        auto weightFn = [](size_t, unsigned) -> Scalar { return 1.0; };
+        auto updateFn =
+            [&changeIndicator](size_t i, unsigned j) -> Scalar
+            {
+                Scalar delta = changeIndicator[i][j];
+                // make sure that non-finite changes do not count as stagnation
+                return std::isfinite(delta) ? std::abs(delta) : std::numeric_limits<Scalar>::infinity();
+            };
+
+        const auto& norms = computeConvergenceNorms(curResid, weightFn, updateFn, comm_);
+
         lastResidualError_ = residualError_;
-        residualError_ = 0.0;
-        stagnates_ = true;
-        for (size_t i = 0; i < curResid.size(); ++i) {
-            for (unsigned j = 0; j < BlockType::dimension; ++j) {
-                residualError_ =
-                    std::max<Scalar>(residualError_,
-                                     std::abs(curResid[i][j]));
-
-                if (stagnates_ && changeIndicator[i][j] != 0.0)
-                    // only stagnation means that we've failed!
-                    stagnates_ = false;
-            }
-        }
-
-        residualError_ = comm_.max(residualError_);
-
-        // the linear solver only stagnates if all processes stagnate
-        stagnates_ = comm_.min(stagnates_);
+        residualError_ = norms.residual;
+
+        // the linear solver only stagnates if the solution did not change on any
+        // process. (only stagnation means that we've failed!)
+        stagnates_ = (norms.update == 0.0);
     }
 
     const CollectiveCommunication& comm_;
@@ -32,9 +32,11 @@
 #include <dune/common/version.hh>
 #include <dune/common/fvector.hh>
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <iomanip>
+#include <limits>
 
 namespace Opm {
 namespace Linear {
@@ -149,6 +151,76 @@ public:
     {}
 };
 
+/*!
+ * \brief The global infinity norms which are required by the convergence criteria.
+ */
+template <class Scalar>
+struct ConvergenceNorms
+{
+    //! The maximum of the absolute values of the residual
+    Scalar residual;
+
+    //! The maximum of the weighted absolute values of the residual
+    Scalar weightedResidual;
+
+    //! The maximum of the measure for the update of the solution
+    Scalar update;
+};
+
+/*!
+ * \brief Compute the norms of the residual and of the update of the solution in a single
+ *        sweep over the vectors.
+ *
+ * The sweep is distributed over the threads if OpenMP is enabled and the results of
+ * all processes are combined using a single collective communication.
+ *
+ * \param curResid The residual of the current iterative solution
+ * \param weightFn Callable which returns the weight of component (i, j) of the residual
+ * \param updateFn Callable which returns the measure for the update of component (i, j)
+ *                 of the solution. It is called exactly once for each component, so it
+ *                 may also be used to update some per-component state.
+ * \param comm The collective communication object used to reduce the norms
+ */
+template <class Vector, class WeightFn, class UpdateFn, class CollectiveCommunication>
+ConvergenceNorms<typename Vector::field_type>
+computeConvergenceNorms(const Vector& curResid,
+                        const WeightFn& weightFn,
+                        const UpdateFn& updateFn,
+                        const CollectiveCommunication& comm)
+{
+    typedef typename Vector::field_type Scalar;
+    enum { blockSize = Vector::block_type::dimension };
+
+    // do not bother to start threads for small vectors
+    static const long minSizeForThreads = 10000;
+
+    long n = static_cast<long>(curResid.size());
+    Scalar residualError = 0.0;
+    Scalar weightedResidualError = 0.0;
+    Scalar updateError = 0.0;
+
+#ifdef _OPENMP
+#pragma omp parallel for reduction(max: residualError, weightedResidualError, updateError) if (n >= minSizeForThreads)
+#endif
+    for (long i = 0; i < n; ++i) {
+        for (unsigned j = 0; j < blockSize; ++j) {
+            Scalar absResid = std::abs(curResid[i][j]);
+            residualError = std::max<Scalar>(residualError, absResid);
+            weightedResidualError = std::max<Scalar>(weightedResidualError, weightFn(i, j)*absResid);
+            updateError = std::max<Scalar>(updateError, updateFn(i, j));
+        }
+    }
+
+    Scalar values[3] = { residualError, weightedResidualError, updateError };
+    comm.max(values, 3);
+
+    ConvergenceNorms<Scalar> result;
+    result.residual = values[0];
+    result.weightedResidual = values[1];
+    result.update = values[2];
+    return result;
+}
+
 //! \} end documentation
 
 }} // end namespace Linear, Opm
@@ -0,0 +1,297 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::CprPreconditioner
+ */
+#ifndef EWOMS_CPR_PRECONDITIONER_HH
+#define EWOMS_CPR_PRECONDITIONER_HH
+
+#include <opm/material/common/Unused.hpp>
+
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/paamg/amg.hh>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/version.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief A two-stage constrained pressure residual (CPR) preconditioner.
+ *
+ * The first stage restricts the residual to a scalar pressure system using
+ * quasi-IMPES weights and approximately solves it using one cycle of an algebraic
+ * multi-grid preconditioner. The second stage applies an ILU(0) decomposition of the
+ * full block system to the residual which remains after the pressure correction.
+ *
+ * The quasi-IMPES weights of a row of blocks are the solution of \f$D^T w = e_p\f$,
+ * where \f$D\f$ is the diagonal block of the row and \f$e_p\f$ is the unit vector of
+ * the pressure primary variable, i.e., they are the linear combination of the
+ * equations of a degree of freedom which eliminates the local dependence on all
+ * non-pressure primary variables.
+ *
+ * Note that this class is a sequential preconditioner: In parallel runs, it is used
+ * on the domestic overlap of each process like all other preconditioners provided
+ * via the preconditioner wrappers.
+ */
+template <class Matrix, class Vector>
+class CprPreconditioner : public Dune::Preconditioner<Vector, Vector>
+{
+    typedef typename Vector::block_type VectorBlock;
+    typedef typename VectorBlock::field_type Scalar;
+    enum { numEq = VectorBlock::dimension };
+
+    typedef Dune::BlockVector<VectorBlock> BlockVector;
+    typedef Dune::FieldMatrix<Scalar, numEq, numEq> DenseBlock;
+
+    typedef Dune::BCRSMatrix<Dune::FieldMatrix<Scalar, 1, 1> > PressureMatrix;
+    typedef Dune::BlockVector<Dune::FieldVector<Scalar, 1> > PressureVector;
+    typedef Dune::MatrixAdapter<PressureMatrix, PressureVector, PressureVector> PressureOperator;
+    typedef Dune::SeqSSOR<PressureMatrix, PressureVector, PressureVector> PressureSmoother;
+    typedef Dune::Amg::AMG<PressureOperator, PressureVector, PressureSmoother> PressureAmg;
+
+#if DUNE_VERSION_NEWER(DUNE_ISTL, 2,7)
+    typedef Dune::SeqILU<Matrix, BlockVector, BlockVector> FullSystemIlu;
+#else
+    typedef Dune::SeqILU0<Matrix, BlockVector, BlockVector> FullSystemIlu;
+#endif
+
+public:
+    typedef Vector domain_type;
+    typedef Vector range_type;
+    typedef Scalar field_type;
+
+    /*!
+     * \brief Set up the preconditioner for a given matrix.
+     *
+     * \param matrix The matrix of the full linear system of equations
+     * \param pressureVarIdx The index of the pressure primary variable
+     * \param coarsenTarget The coarsening target for the AMG of the pressure system
+     * \param iluRelaxation The relaxation factor of the ILU(0) stage
+     * \param verbosity The verbosity level of the AMG
+     */
+    CprPreconditioner(const Matrix& matrix,
+                      unsigned pressureVarIdx,
+                      int coarsenTarget,
+                      Scalar iluRelaxation,
+                      int verbosity = 0)
+        : matrix_(matrix)
+        , pressureVarIdx_(pressureVarIdx)
+    {
+        computeWeights_();
+        assemblePressureMatrix_();
+        setupAmg_(coarsenTarget, verbosity);
+
+        fullIlu_.reset(new FullSystemIlu(matrix_, iluRelaxation));
+
+        size_t n = matrix_.N();
+        pressureRhs_.resize(n);
+        pressureSol_.resize(n);
+        residual_.resize(n);
+        update_.resize(n);
+    }
+
+    //! the kind of computations supported by the preconditioner
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::sequential; }
+
+    /*!
+     * \brief Prepare the preconditioner for the iterations of a linear solver.
+     */
+    void pre(Vector& x OPM_UNUSED, Vector& b OPM_UNUSED) override
+    {
+        pressureSol_ = 0.0;
+        pressureRhs_ = 0.0;
+        amg_->pre(pressureSol_, pressureRhs_);
+    }
+
+    /*!
+     * \brief Apply both stages of the preconditioner.
+     */
+    void apply(Vector& x, const Vector& d) override
+    {
+        size_t n = matrix_.N();
+
+        // first stage: restrict the residual to the pressure system and correct the
+        // pressure using one AMG cycle
+        for (size_t rowIdx = 0; rowIdx < n; ++rowIdx)
+            pressureRhs_[rowIdx] = weights_[rowIdx]*d[rowIdx];
+
+        pressureSol_ = 0.0;
+        amg_->apply(pressureSol_, pressureRhs_);
+
+        for (size_t rowIdx = 0; rowIdx < n; ++rowIdx) {
+            x[rowIdx] = 0.0;
+            x[rowIdx][pressureVarIdx_] = pressureSol_[rowIdx][0];
+        }
+
+        // second stage: smooth the remaining residual of the full system using ILU(0)
+        for (size_t rowIdx = 0; rowIdx < n; ++rowIdx)
+            residual_[rowIdx] = d[rowIdx];
+        matrix_.mmv(x, residual_);
+
+        update_ = 0.0;
+        fullIlu_->apply(update_, residual_);
+
+        for (size_t rowIdx = 0; rowIdx < n; ++rowIdx)
+            x[rowIdx] += update_[rowIdx];
+    }
+
+    /*!
+     * \brief Clean up after the iterations of a linear solver.
+     */
+    void post(Vector& x OPM_UNUSED) override
+    { amg_->post(pressureSol_); }
+
+private:
+    void computeWeights_()
+    {
+        size_t n = matrix_.N();
+        weights_.resize(n);
+
+        for (size_t rowIdx = 0; rowIdx < n; ++rowIdx) {
+            VectorBlock& w = weights_[rowIdx];
+
+            // solve D^T w = e_p by inverting the transposed diagonal block
+            DenseBlock diagT;
+            const auto& diag = matrix_[rowIdx][rowIdx];
+            for (unsigned i = 0; i < numEq; ++i)
+                for (unsigned j = 0; j < numEq; ++j)
+                    diagT[i][j] = diag[j][i];
+
+            bool valid = true;
+            try {
+                diagT.invert();
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+                    w[eqIdx] = diagT[eqIdx][pressureVarIdx_];
+                    valid = valid && std::isfinite(w[eqIdx]);
+                }
+            }
+            catch (const Dune::FMatrixError&) {
+                valid = false;
+            }
+
+            // fall back to the plain pressure equation if the diagonal block is
+            // singular
+            if (!valid) {
+                w = 0.0;
+                w[pressureVarIdx_] = 1.0;
+                continue;
+            }
+
+            // normalize the weights. this only scales the rows of the pressure
+            // system, but keeps the magnitude of its entries reasonable for the AMG.
+            Scalar maxWeight = w.infinity_norm();
+            if (maxWeight > 0.0)
+                w /= maxWeight;
+        }
+    }
+
+    void assemblePressureMatrix_()
+    {
+        size_t n = matrix_.N();
+        pressureMatrix_.reset(new PressureMatrix(n, n, matrix_.nonzeroes(), PressureMatrix::row_wise));
+
+        // the pressure system uses the sparsity pattern of the block matrix
+        auto pRowIt = pressureMatrix_->createbegin();
+        const auto& pRowEndIt = pressureMatrix_->createend();
+        for (; pRowIt != pRowEndIt; ++pRowIt) {
+            const auto& row = matrix_[pRowIt.index()];
+            auto colIt = row.begin();
+            const auto& colEndIt = row.end();
+            for (; colIt != colEndIt; ++colIt)
+                pRowIt.insert(colIt.index());
+        }
+
+        // A_p(i, j) = sum_k w_i[k] * A_ij[k][p]
+        for (size_t rowIdx = 0; rowIdx < n; ++rowIdx) {
+            const auto& w = weights_[rowIdx];
+            const auto& row = matrix_[rowIdx];
+            auto& pRow = (*pressureMatrix_)[rowIdx];
+
+            auto colIt = row.begin();
+            const auto& colEndIt = row.end();
+            for (; colIt != colEndIt; ++colIt) {
+                const auto& block = *colIt;
+                Scalar value = 0.0;
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    value += w[eqIdx]*block[eqIdx][pressureVarIdx_];
+                pRow[colIt.index()] = value;
+            }
+        }
+    }
+
+    void setupAmg_(int coarsenTarget, int verbosity)
+    {
+        pressureOperator_.reset(new PressureOperator(*pressureMatrix_));
+
+        typedef typename Dune::Amg::SmootherTraits<PressureSmoother>::Arguments SmootherArgs;
+        SmootherArgs smootherArgs;
+        smootherArgs.iterations = 1;
+        smootherArgs.relaxationFactor = 1.0;
+
+        // the pressure system is not symmetric in general
+        typedef Dune::Amg::CoarsenCriterion<
+            Dune::Amg::UnSymmetricCriterion<PressureMatrix, Dune::Amg::FirstDiagonal> >
+            CoarsenCriterion;
+        CoarsenCriterion coarsenCriterion(/*maxLevel=*/15, coarsenTarget);
+        coarsenCriterion.setDefaultValuesIsotropic(/*dim=*/2, /*aggregateSizePerDim=*/2);
+        coarsenCriterion.setDebugLevel((verbosity > 0) ? 1 : 0);
+        coarsenCriterion.setMinCoarsenRate(1.05);
+        coarsenCriterion.setAccumulate(Dune::Amg::atOnceAccu);
+        coarsenCriterion.setSkipIsolated(false);
+
+        amg_.reset(new PressureAmg(*pressureOperator_, coarsenCriterion, smootherArgs));
+    }
+
+    const Matrix& matrix_;
+    unsigned pressureVarIdx_;
+
+    std::vector<VectorBlock> weights_;
+
+    std::unique_ptr<PressureMatrix> pressureMatrix_;
+    std::unique_ptr<PressureOperator> pressureOperator_;
+    std::unique_ptr<PressureAmg> amg_;
+    std::unique_ptr<FullSystemIlu> fullIlu_;
+
+    PressureVector pressureRhs_;
+    PressureVector pressureSol_;
+    BlockVector residual_;
+    BlockVector update_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
@@ -80,13 +80,27 @@ public:
         myRank_ = static_cast<ProcessRank>(tmp);
         MPI_Comm_size(MPI_COMM_WORLD, &tmp);
         worldSize_ = static_cast<unsigned>(tmp);
+
+        // the values of the overlapping vectors and matrices are exchanged using a
+        // private communicator, so that their messages can never be confused with
+        // the ones of other code
+        MPI_Comm_dup(MPI_COMM_WORLD, &communicator_);
 #endif // HAVE_MPI
 
         buildDomesticOverlap_();
         updateMasterRanks_();
+        setupIndexMapping_();
         blackList_.updateNativeToDomesticMap(*this);
+    }
 
-        setupDebugMapping_();
+    ~DomesticOverlapFromBCRSMatrix()
+    {
+#if HAVE_MPI
+        int finalized;
+        MPI_Finalized(&finalized);
+        if (!finalized)
+            MPI_Comm_free(&communicator_);
+#endif // HAVE_MPI
     }
 
     void check() const
@@ -138,6 +152,17 @@ public:
     unsigned worldSize() const
     { return worldSize_; }
 
+#if HAVE_MPI
+    /*!
+     * \brief Returns the MPI communicator which ought to be used to synchronize
+     *        the values of overlapping objects.
+     *
+     * This is a duplicate of MPI_COMM_WORLD.
+     */
+    MPI_Comm communicator() const
+    { return communicator_; }
+#endif // HAVE_MPI
+
     /*!
      * \brief Return the set of process ranks which share an overlap
      *        with the current process.
@@ -226,6 +251,18 @@ public:
     size_t numLocal() const
     { return foreignOverlap_.numLocal(); }
 
+    /*!
+     * \brief Returns the number of domestic indices for which the current
+     *        process is the master.
+     *
+     * The domestic indices are ordered such that these indices form the
+     * contiguous range [0, numMaster()). They are followed by the remaining
+     * local indices (i.e., the border indices which are owned by a peer) and
+     * finally by the domestic overlap.
+     */
+    size_t numMaster() const
+    { return numMaster_; }
+
     /*!
      * \brief Returns the number domestic indices.
      *
@@ -251,9 +288,9 @@ public:
      */
     bool iAmMasterOf(Index domesticIdx) const
     {
-        if (!isLocal(domesticIdx))
-            return false;
-        return foreignOverlap_.iAmMasterOf(mapExternalToInternal_(domesticIdx));
+        // the indices for which the current process is the master are the
+        // first ones of the domestic indices
+        return domesticIdx >= 0 && static_cast<size_t>(domesticIdx) < numMaster_;
     }
 
     /*!
@@ -534,34 +571,65 @@ protected:
 #endif // HAVE_MPI
     }
 
-    // this method is intended to set up the code mapping code for
-    // mapping domestic indices to the same ones used by a sequential
-    // grid. this requires detailed knowledge about how a grid
-    // distributes the degrees of freedom over multiple processes, but
-    // it can simplify debugging considerably because the indices can
-    // be made identical for the parallel and the sequential
-    // computations.
-    //
-    // by default, this method does nothing
-    void setupDebugMapping_()
-    {}
-
-    // this method is intended to map domestic indices to the ones
-    // used by a sequential grid.
-    //
-    // by default, this method does nothing
+    // set up the mapping between the domestic indices which are used by the
+    // foreign overlap and the global indices ("internal" indices) and the ones
+    // which are exposed to the outside ("external" indices). The external
+    // indices are ordered such that the indices for which the current process
+    // is the master come first, followed by the remaining local indices and
+    // finally the indices of the domestic overlap. This allows reductions over
+    // the indices owned by the process to be done using a contiguous loop.
+    void setupIndexMapping_()
+    {
+        size_t nLocal = numLocal();
+        size_t nDomestic = numDomestic();
+
+        externalToInternal_.clear();
+        externalToInternal_.reserve(nDomestic);
+
+        // indices for which we are the master
+        for (unsigned i = 0; i < nLocal; ++i)
+            if (foreignOverlap_.iAmMasterOf(static_cast<Index>(i)))
+                externalToInternal_.push_back(static_cast<Index>(i));
+        numMaster_ = externalToInternal_.size();
+
+        // local indices which are owned by some peer process
+        for (unsigned i = 0; i < nLocal; ++i)
+            if (!foreignOverlap_.iAmMasterOf(static_cast<Index>(i)))
+                externalToInternal_.push_back(static_cast<Index>(i));
+
+        // the domestic overlap
+        for (size_t i = nLocal; i < nDomestic; ++i)
+            externalToInternal_.push_back(static_cast<Index>(i));
+
+        internalToExternal_.resize(nDomestic);
+        for (unsigned externalIdx = 0; externalIdx < nDomestic; ++externalIdx)
+            internalToExternal_[static_cast<unsigned>(externalToInternal_[externalIdx])] =
+                static_cast<Index>(externalIdx);
+    }
+
+    // map the domestic indices used internally to the ones exposed by the
+    // public interface of the class
     Index mapInternalToExternal_(Index internalIdx) const
-    { return internalIdx; }
+    {
+        if (internalIdx < 0)
+            return internalIdx;
+        return internalToExternal_[static_cast<unsigned>(internalIdx)];
+    }
 
-    // this method is intended to map the indices used by a sequential
-    // to grid domestic indices ones.
-    //
-    // by default, this method does nothing
+    // map the domestic indices exposed by the public interface of the class to
+    // the ones which are used internally
     Index mapExternalToInternal_(Index externalIdx) const
-    { return externalIdx; }
+    {
+        if (externalIdx < 0)
+            return externalIdx;
+        return externalToInternal_[static_cast<unsigned>(externalIdx)];
+    }
 
     ProcessRank myRank_;
     unsigned worldSize_;
+#if HAVE_MPI
+    MPI_Comm communicator_;
+#endif // HAVE_MPI
     ForeignOverlap foreignOverlap_;
 
     BlackList blackList_;
@@ -571,6 +639,10 @@ protected:
     std::vector<BorderDistance> borderDistance_;
     std::vector<ProcessRank> masterRank_;
 
+    std::vector<Index> internalToExternal_;
+    std::vector<Index> externalToInternal_;
+    size_t numMaster_;
+
     std::map<ProcessRank, MpiBuffer<size_t> *> numIndicesSendBuffer_;
     std::map<ProcessRank, MpiBuffer<IndexDistanceNpeers> *> indicesSendBuffer_;
     GlobalIndices globalIndices_;
@@ -39,12 +39,14 @@
  * - \c SOR: A successive overrelaxation (SOR) preconditioner
  * - \c ILUn: An ILU(n) preconditioner
  * - \c ILU0: A specialized (and optimized) ILU(0) preconditioner
+ * - \c Cpr: A two-stage constrained pressure residual (CPR) preconditioner
  */
 #ifndef EWOMS_ISTL_PRECONDITIONER_WRAPPERS_HH
 #define EWOMS_ISTL_PRECONDITIONER_WRAPPERS_HH
 
 #include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/parametersystem.hh>
+#include <opm/simulators/linalg/cprpreconditioner.hh>
 
 #include <dune/istl/preconditioners.hh>
 
@@ -57,6 +59,10 @@ NEW_PROP_TAG(OverlappingMatrix);
 NEW_PROP_TAG(OverlappingVector);
 NEW_PROP_TAG(PreconditionerOrder);
 NEW_PROP_TAG(PreconditionerRelaxation);
+NEW_PROP_TAG(Indices);
+NEW_PROP_TAG(LinearSolverVerbosity);
+NEW_PROP_TAG(CprPressureVarIdx);
+NEW_PROP_TAG(CprAmgCoarsenTarget);
 END_PROPERTIES
 
 namespace Opm {
@@ -199,6 +205,85 @@ EWOMS_WRAP_ISTL_SIMPLE_PRECONDITIONER(ILU0, Dune::SeqILU0)
 EWOMS_WRAP_ISTL_PRECONDITIONER(ILUn, Dune::SeqILUn)
 #endif
 
+/*!
+ * \brief Preconditioner wrapper for the two-stage constrained pressure residual
+ *        preconditioner.
+ *
+ * The AMG of the pressure stage is set up from scratch each time the preconditioner
+ * is prepared, the ILU(0) stage uses the PreconditionerRelaxation parameter. Unless
+ * the CprPressureVarIdx parameter is specified explicitly, the index of the pressure
+ * primary variable is taken from the model's Indices: 'pressureSwitchIdx' for the
+ * black-oil model, 'pressure0Idx' for most others.
+ */
+template <class TypeTag>
+class PreconditionerWrapperCpr
+{
+    typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
+    typedef typename GET_PROP_TYPE(TypeTag, OverlappingMatrix) OverlappingMatrix;
+    typedef typename GET_PROP_TYPE(TypeTag, OverlappingVector) OverlappingVector;
+    typedef typename GET_PROP_TYPE(TypeTag, Indices) Indices;
+
+public:
+    typedef Opm::Linear::CprPreconditioner<OverlappingMatrix, OverlappingVector>
+            SequentialPreconditioner;
+
+    PreconditionerWrapperCpr()
+    {}
+
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, PreconditionerRelaxation,
+                             "The relaxation factor of the preconditioner");
+        EWOMS_REGISTER_PARAM(TypeTag, int, CprPressureVarIdx,
+                             "The index of the pressure primary variable used by the "
+                             "CPR preconditioner. -1 means that it is determined by the "
+                             "model");
+        EWOMS_REGISTER_PARAM(TypeTag, int, CprAmgCoarsenTarget,
+                             "The coarsening target for the AMG of the pressure "
+                             "system of the CPR preconditioner");
+    }
+
+    void prepare(OverlappingMatrix& matrix)
+    {
+        Scalar relaxationFactor = EWOMS_GET_PARAM(TypeTag, Scalar, PreconditionerRelaxation);
+        int pressureVarIdx = EWOMS_GET_PARAM(TypeTag, int, CprPressureVarIdx);
+        if (pressureVarIdx < 0)
+            pressureVarIdx = static_cast<int>(defaultPressureVarIdx_<Indices>(0));
+        int coarsenTarget = EWOMS_GET_PARAM(TypeTag, int, CprAmgCoarsenTarget);
+
+        int verbosity = 0;
+        if (matrix.overlap().myRank() == 0)
+            verbosity = EWOMS_GET_PARAM(TypeTag, int, LinearSolverVerbosity);
+
+        seqPreCond_ = new SequentialPreconditioner(matrix,
+                                                   static_cast<unsigned>(pressureVarIdx),
+                                                   coarsenTarget,
+                                                   relaxationFactor,
+                                                   verbosity);
+    }
+
+    SequentialPreconditioner& get()
+    { return *seqPreCond_; }
+
+    void cleanup()
+    { delete seqPreCond_; }
+
+private:
+    template <class I>
+    static auto defaultPressureVarIdx_(int) -> decltype(static_cast<unsigned>(I::pressureSwitchIdx))
+    { return static_cast<unsigned>(I::pressureSwitchIdx); }
+
+    template <class I>
+    static auto defaultPressureVarIdx_(long) -> decltype(static_cast<unsigned>(I::pressure0Idx))
+    { return static_cast<unsigned>(I::pressure0Idx); }
+
+    template <class I>
+    static unsigned defaultPressureVarIdx_(...)
+    { return 0; }
+
+    SequentialPreconditioner *seqPreCond_;
+};
+
 #undef EWOMS_WRAP_ISTL_PRECONDITIONER
 }} // namespace Linear, Opm
 
@@ -31,6 +31,12 @@
 #include <dune/istl/paamg/amg.hh>
 
 #include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define EWOMS_MATRIX_BLOCK_USE_AVX2 1
+#endif
 
 namespace Opm {
 namespace MatrixBlockHelp {
@@ -204,17 +210,259 @@ static inline void invertMatrix(Dune::FieldMatrix<K, 4, 4>& matrix)
     else
         matrix *= 1.0/det;
 }
+
+/*!
+ * \brief The arithmetic kernels used by the MatrixBlock class.
+ *
+ * The generic version uses plain loops whose trip counts are known at compile
+ * time. For double precision blocks with up to six rows and columns, they are
+ * replaced by explicitly vectorized versions if the code is compiled with support
+ * for AVX2 and FMA.
+ */
+template <class K, int n, int m>
+struct BlockKernels
+{
+    static constexpr bool isVectorized = false;
+
+    //! result = A*x
+    template <class Matrix>
+    static void mult(const Matrix& A, const K* x, K* result)
+    {
+        for (int i = 0; i < n; ++i) {
+            K tmp = 0.0;
+            for (int j = 0; j < m; ++j)
+                tmp += A[i][j]*x[j];
+            result[i] = tmp;
+        }
+    }
+
+    //! A = A*B
+    template <class Matrix, class Matrix2>
+    static void rightmultiply(Matrix& A, const Matrix2& B)
+    {
+        for (int i = 0; i < n; ++i) {
+            K row[m];
+            for (int j = 0; j < m; ++j) {
+                row[j] = 0.0;
+                for (int k = 0; k < m; ++k)
+                    row[j] += A[i][k]*B[k][j];
+            }
+            for (int j = 0; j < m; ++j)
+                A[i][j] = row[j];
+        }
+    }
+
+    //! A = B*A
+    template <class Matrix, class Matrix2>
+    static void leftmultiply(Matrix& A, const Matrix2& B)
+    {
+        K tmp[n][m];
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < m; ++j)
+                tmp[i][j] = A[i][j];
+
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < m; ++j) {
+                K value = 0.0;
+                for (int k = 0; k < n; ++k)
+                    value += B[i][k]*tmp[k][j];
+                A[i][j] = value;
+            }
+        }
+    }
+};
+
+#if EWOMS_MATRIX_BLOCK_USE_AVX2
+/*!
+ * \brief AVX2 kernels for square double precision blocks of size 2 to 6.
+ *
+ * A row of a block is held in a 256 bit register for its first four entries (the
+ * "head") and a 128 bit register for the remaining ones (the "tail"). Blocks smaller
+ * than 4x4 use masked loads and stores, so no memory outside of a block is
+ * accessed.
+ */
+template <int n>
+struct AvxBlockKernels
+{
+    static_assert(2 <= n && n <= 6, "The AVX2 kernels only support blocks of size 2 to 6");
+
+    static constexpr bool isVectorized = true;
+    static constexpr int headSize = (n < 4) ? n : 4;
+    static constexpr int tailSize = (n > 4) ? n - 4 : 0;
+
+    static __m256i mask_(int count)
+    {
+        return _mm256_set_epi64x((count > 3) ? -1 : 0,
+                                 (count > 2) ? -1 : 0,
+                                 (count > 1) ? -1 : 0,
+                                 -1);
+    }
+
+    static __m256d loadHead_(const double* p)
+    {
+        if (headSize == 4)
+            return _mm256_loadu_pd(p);
+        return _mm256_maskload_pd(p, mask_(headSize));
+    }
+
+    static void storeHead_(double* p, __m256d v)
+    {
+        if (headSize == 4)
+            _mm256_storeu_pd(p, v);
+        else
+            _mm256_maskstore_pd(p, mask_(headSize), v);
+    }
+
+    static __m128d loadTail_(const double* p)
+    {
+        if (tailSize == 2)
+            return _mm_loadu_pd(p + 4);
+        if (tailSize == 1)
+            return _mm_load_sd(p + 4);
+        return _mm_setzero_pd();
+    }
+
+    static void storeTail_(double* p, __m128d v)
+    {
+        if (tailSize == 2)
+            _mm_storeu_pd(p + 4, v);
+        else if (tailSize == 1)
+            _mm_store_sd(p + 4, v);
+    }
+
+    // computes the dot products of the rows [firstRow, firstRow + 4) of A with x
+    template <class Matrix>
+    static __m256d rowDots_(const Matrix& A, int firstRow, __m256d xHead, __m128d xTail)
+    {
+        __m256d p[4];
+        __m128d q[4];
+        for (int k = 0; k < 4; ++k) {
+            int rowIdx = firstRow + k;
+            if (rowIdx < n) {
+                const double* row = &A[rowIdx][0];
+                p[k] = _mm256_mul_pd(loadHead_(row), xHead);
+                q[k] = _mm_mul_pd(loadTail_(row), xTail);
+            }
+            else {
+                p[k] = _mm256_setzero_pd();
+                q[k] = _mm_setzero_pd();
+            }
+        }
+
+        // horizontally add the products of the four rows
+        __m256d t0 = _mm256_hadd_pd(p[0], p[1]);
+        __m256d t1 = _mm256_hadd_pd(p[2], p[3]);
+        __m256d result =
+            _mm256_add_pd(_mm256_permute2f128_pd(t0, t1, 0x20),
+                          _mm256_permute2f128_pd(t0, t1, 0x31));
+
+        if (tailSize > 0) {
+            __m128d u0 = _mm_hadd_pd(q[0], q[1]);
+            __m128d u1 = _mm_hadd_pd(q[2], q[3]);
+            result = _mm256_add_pd(result,
+                                   _mm256_insertf128_pd(_mm256_castpd128_pd256(u0), u1, 1));
+        }
+
+        return result;
+    }
+
+    template <class Matrix>
+    static void mult(const Matrix& A, const double* x, double* result)
+    {
+        __m256d xHead = loadHead_(x);
+        __m128d xTail = loadTail_(x);
+
+        double tmp[8];
+        _mm256_storeu_pd(tmp, rowDots_(A, 0, xHead, xTail));
+        if (n > 4)
+            _mm256_storeu_pd(tmp + 4, rowDots_(A, 4, xHead, xTail));
+
+        for (int i = 0; i < n; ++i)
+            result[i] = tmp[i];
+    }
+
+    template <class Matrix, class Matrix2>
+    static void rightmultiply(Matrix& A, const Matrix2& B)
+    {
+        __m256d bHead[n];
+        __m128d bTail[n];
+        for (int k = 0; k < n; ++k) {
+            bHead[k] = loadHead_(&B[k][0]);
+            bTail[k] = loadTail_(&B[k][0]);
+        }
+
+        for (int i = 0; i < n; ++i) {
+            double* row = &A[i][0];
+            __m256d accHead = _mm256_setzero_pd();
+            __m128d accTail = _mm_setzero_pd();
+            for (int k = 0; k < n; ++k) {
+                accHead = _mm256_fmadd_pd(_mm256_set1_pd(row[k]), bHead[k], accHead);
+                if (tailSize > 0)
+                    accTail = _mm_fmadd_pd(_mm_set1_pd(row[k]), bTail[k], accTail);
+            }
+            storeHead_(row, accHead);
+            storeTail_(row, accTail);
+        }
+    }
+
+    template <class Matrix, class Matrix2>
+    static void leftmultiply(Matrix& A, const Matrix2& B)
+    {
+        __m256d aHead[n];
+        __m128d aTail[n];
+        for (int k = 0; k < n; ++k) {
+            aHead[k] = loadHead_(&A[k][0]);
+            aTail[k] = loadTail_(&A[k][0]);
+        }
+
+        for (int i = 0; i < n; ++i) {
+            const double* bRow = &B[i][0];
+            __m256d accHead = _mm256_setzero_pd();
+            __m128d accTail = _mm_setzero_pd();
+            for (int k = 0; k < n; ++k) {
+                accHead = _mm256_fmadd_pd(_mm256_set1_pd(bRow[k]), aHead[k], accHead);
+                if (tailSize > 0)
+                    accTail = _mm_fmadd_pd(_mm_set1_pd(bRow[k]), aTail[k], accTail);
+            }
+            storeHead_(&A[i][0], accHead);
+            storeTail_(&A[i][0], accTail);
+        }
+    }
+};
+
+template <>
+struct BlockKernels<double, 2, 2> : public AvxBlockKernels<2> {};
+template <>
+struct BlockKernels<double, 3, 3> : public AvxBlockKernels<3> {};
+template <>
+struct BlockKernels<double, 4, 4> : public AvxBlockKernels<4> {};
+template <>
+struct BlockKernels<double, 5, 5> : public AvxBlockKernels<5> {};
+template <>
+struct BlockKernels<double, 6, 6> : public AvxBlockKernels<6> {};
+#endif // EWOMS_MATRIX_BLOCK_USE_AVX2
+
 } // namespace MatrixBlockHelp
 
 template <class Scalar, int n, int m>
 class MatrixBlock : public Dune::FieldMatrix<Scalar, n, m>
 {
+    typedef Opm::MatrixBlockHelp::BlockKernels<Scalar, n, m> Kernels;
+    typedef Dune::FieldVector<Scalar, m> DomainVector;
+    typedef Dune::FieldVector<Scalar, n> RangeVector;
+
 public:
     typedef Dune::FieldMatrix<Scalar, n, m>  BaseType;
 
     using BaseType::operator= ;
     using BaseType::rows;
     using BaseType::cols;
+    using BaseType::mv;
+    using BaseType::umv;
+    using BaseType::mmv;
+    using BaseType::usmv;
+    using BaseType::rightmultiply;
+    using BaseType::leftmultiply;
 
     MatrixBlock()
         : BaseType(Scalar(0.0))
@@ -227,6 +475,58 @@ public:
     void invert()
     { Opm::MatrixBlockHelp::invertMatrix(asBase()); }
 
+    /*!
+     * \brief y = A*x
+     *
+     * This and the following methods hide the generic versions of Dune::FieldMatrix
+     * for the vector and block types used by the linear solvers, so that the
+     * sparse matrix-vector products and the ILU decomposition of BCRSMatrix objects
+     * use the kernels of MatrixBlockHelp::BlockKernels.
+     */
+    void mv(const DomainVector& x, RangeVector& y) const
+    { Kernels::mult(*this, &x[0], &y[0]); }
+
+    //! y += A*x
+    void umv(const DomainVector& x, RangeVector& y) const
+    {
+        Scalar tmp[n];
+        Kernels::mult(*this, &x[0], tmp);
+        for (int i = 0; i < n; ++i)
+            y[i] += tmp[i];
+    }
+
+    //! y -= A*x
+    void mmv(const DomainVector& x, RangeVector& y) const
+    {
+        Scalar tmp[n];
+        Kernels::mult(*this, &x[0], tmp);
+        for (int i = 0; i < n; ++i)
+            y[i] -= tmp[i];
+    }
+
+    //! y += alpha*A*x
+    void usmv(const Scalar& alpha, const DomainVector& x, RangeVector& y) const
+    {
+        Scalar tmp[n];
+        Kernels::mult(*this, &x[0], tmp);
+        for (int i = 0; i < n; ++i)
+            y[i] += alpha*tmp[i];
+    }
+
+    //! A = A*M
+    MatrixBlock& rightmultiply(const MatrixBlock<Scalar, m, m>& M)
+    {
+        Kernels::rightmultiply(*this, M);
+        return *this;
+    }
+
+    //! A = M*A
+    MatrixBlock& leftmultiply(const MatrixBlock<Scalar, n, n>& M)
+    {
+        Kernels::leftmultiply(*this, M);
+        return *this;
+    }
+
     const BaseType& asBase() const
     { return static_cast<const BaseType&>(*this); }
 
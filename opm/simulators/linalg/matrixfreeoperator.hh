@@ -0,0 +1,166 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::MatrixFreeOverlappingOperator
+ */
+#ifndef EWOMS_MATRIX_FREE_OPERATOR_HH
+#define EWOMS_MATRIX_FREE_OPERATOR_HH
+
+#include <opm/models/utils/propertysystem.hh>
+#include <opm/models/utils/parametersystem.hh>
+
+#include <dune/istl/operators.hh>
+#include <dune/common/version.hh>
+
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+BEGIN_PROPERTIES
+
+NEW_PROP_TAG(Scalar);
+NEW_PROP_TAG(Evaluation);
+NEW_PROP_TAG(Simulator);
+NEW_PROP_TAG(GlobalEqVector);
+NEW_PROP_TAG(OverlappingMatrix);
+NEW_PROP_TAG(OverlappingVector);
+NEW_PROP_TAG(EnableMatrixFreeLinearization);
+NEW_PROP_TAG(LinearSolverScaleBlockDiagonal);
+
+END_PROPERTIES
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief An overlap aware linear operator which applies the Jacobian of the model
+ *        without assembling it.
+ *
+ * The product of the Jacobian and a vector is computed by
+ * FvBaseLinearizer::applyJacobian(), i.e., the local Jacobian matrices of the elements
+ * are computed using automatic differentiation and are directly multiplied with the
+ * vector. Each application of the operator thus costs about as much as a linearization
+ * of the domain, but the Jacobian matrix is never stored. This allows to solve problems
+ * for which the assembled matrix does not fit into memory.
+ *
+ * The operator requires the EnableMatrixFreeLinearization property to be set. In this
+ * case, the linearizer only assembles the diagonal blocks of the Jacobian matrix, so
+ * the matrix which is seen by the linear solver backend and its preconditioner only
+ * consists of these blocks. The preconditioner thus amounts to a block Jacobi
+ * preconditioner, e.g.:
+ * \code
+ * SET_BOOL_PROP(YourTypeTag, EnableMatrixFreeLinearization, true);
+ * SET_TYPE_PROP(YourTypeTag, OverlappingLinearOperator,
+ *               Opm::Linear::MatrixFreeOverlappingOperator<TypeTag>);
+ * SET_TYPE_PROP(YourTypeTag, PreconditionerWrapper,
+ *               Opm::Linear::PreconditionerWrapperJacobi<TypeTag>);
+ * \endcode
+ *
+ * The operator works with all linear solver backends which are derived from
+ * ParallelBaseBackend. Auxiliary equations (e.g., wells) and the block diagonal
+ * scaling of the linear system are not supported.
+ */
+template <class TypeTag>
+class MatrixFreeOverlappingOperator
+    : public Dune::LinearOperator<typename GET_PROP_TYPE(TypeTag, OverlappingVector),
+                                  typename GET_PROP_TYPE(TypeTag, OverlappingVector)>
+{
+    typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
+    typedef typename GET_PROP_TYPE(TypeTag, Evaluation) Evaluation;
+    typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
+    typedef typename GET_PROP_TYPE(TypeTag, GlobalEqVector) GlobalEqVector;
+    typedef typename GET_PROP_TYPE(TypeTag, OverlappingMatrix) OverlappingMatrix;
+    typedef typename GET_PROP_TYPE(TypeTag, OverlappingVector) OverlappingVector;
+    typedef typename OverlappingMatrix::Overlap Overlap;
+
+    static_assert(GET_PROP_VALUE(TypeTag, EnableMatrixFreeLinearization),
+                  "The matrix-free linear operator requires the "
+                  "EnableMatrixFreeLinearization property to be set");
+    static_assert(!std::is_same<Evaluation, Scalar>::value,
+                  "The matrix-free linear operator requires the local Jacobian matrices "
+                  "to be computed using automatic differentiation");
+
+public:
+    //! export types
+    typedef OverlappingVector domain_type;
+    typedef OverlappingVector range_type;
+    typedef typename OverlappingVector::field_type field_type;
+
+    MatrixFreeOverlappingOperator(const OverlappingMatrix& A, const Simulator& simulator)
+        : A_(A)
+          // applying the Jacobian uses the element contexts of the linearizer, but it
+          // does not modify the state of the model
+        , simulator_(const_cast<Simulator&>(simulator))
+    {
+        if (simulator_.model().numAuxiliaryModules() > 0)
+            throw std::logic_error("The matrix-free linear operator does not support "
+                                   "auxiliary equations");
+        if (EWOMS_GET_PARAM(TypeTag, bool, LinearSolverScaleBlockDiagonal))
+            throw std::logic_error("The matrix-free linear operator cannot be combined with "
+                                   "the block diagonal scaling of the linear system");
+    }
+
+    //! the kind of computations supported by the operator. Either overlapping or non-overlapping
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::overlapping; }
+
+    //! apply operator to x:  \f$ y = A(x) \f$
+    virtual void apply(const OverlappingVector& x, OverlappingVector& y) const override
+    {
+        x.assignTo(x_);
+        simulator_.model().linearizer().applyJacobian(x_, y_);
+
+        // sum up the rows on the process borders in the same way as for the right hand
+        // side of the linear system
+        y.assignAddBorder(y_);
+    }
+
+    //! apply operator to x, scale and add:  \f$ y = y + \alpha A(x) \f$
+    virtual void applyscaleadd(field_type alpha,
+                               const OverlappingVector& x,
+                               OverlappingVector& y) const override
+    {
+        if (!tmp_)
+            tmp_.reset(new OverlappingVector(y));
+
+        apply(x, *tmp_);
+        y.axpy(alpha, *tmp_);
+    }
+
+    const Overlap& overlap() const
+    { return A_.overlap(); }
+
+private:
+    const OverlappingMatrix& A_;
+    Simulator& simulator_;
+
+    mutable GlobalEqVector x_;
+    mutable GlobalEqVector y_;
+    mutable std::unique_ptr<OverlappingVector> tmp_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
@@ -182,6 +182,41 @@ public:
         }
     }
 
+    /*!
+     * \brief Compute \f$ y = A x \f$ for the rows which are seen by peer processes.
+     *
+     * These are the rows for which DomesticOverlapFromBCRSMatrix::isInOverlap() is
+     * true. Together with mvInterior() this allows to overlap the communication of
+     * the result with the computation for the remaining rows.
+     */
+    template <class X, class Y>
+    void mvOverlap(const X& x, Y& y) const
+    { mvRows_(overlapRows_, x, y); }
+
+    /*!
+     * \brief Compute \f$ y = A x \f$ for the rows which are not seen by any peer
+     *        process.
+     */
+    template <class X, class Y>
+    void mvInterior(const X& x, Y& y) const
+    { mvRows_(interiorRows_, x, y); }
+
+    /*!
+     * \brief Compute \f$ y = y + \alpha A x \f$ for the rows which are seen by peer
+     *        processes.
+     */
+    template <class X, class Y>
+    void usmvOverlap(field_type alpha, const X& x, Y& y) const
+    { usmvRows_(overlapRows_, alpha, x, y); }
+
+    /*!
+     * \brief Compute \f$ y = y + \alpha A x \f$ for the rows which are not seen by
+     *        any peer process.
+     */
+    template <class X, class Y>
+    void usmvInterior(field_type alpha, const X& x, Y& y) const
+    { usmvRows_(interiorRows_, alpha, x, y); }
+
     void print() const
     {
         overlap_->print();
@@ -264,62 +299,51 @@ public:
     // communicates and adds up the contents of overlapping rows
     void syncAdd()
     {
-        // first, send all entries to the peers
-        const PeerSet& peerSet = overlap_->peerSet();
-        typename PeerSet::const_iterator peerIt = peerSet.begin();
-        typename PeerSet::const_iterator peerEndIt = peerSet.end();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-
+#if HAVE_MPI
+        // first, post the receive operations and send all entries to the peers
+        startReceives_();
+        for (const ProcessRank peerRank : peerRanks_)
             sendEntries_(peerRank);
-        }
-
-        // then, receive entries from the peers
-        peerIt = peerSet.begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
 
+        // then, add up the entries received from the peers. to make the result
+        // independent of the order in which the messages arrive, the peers are
+        // always processed in the same order.
+        for (const ProcessRank peerRank : peerRanks_) {
+            entryValuesRecvBuff_[peerRank]->wait();
             receiveAddEntries_(peerRank);
         }
 
         // finally, make sure that everything which we send was
         // received by the peers
-        peerIt = peerSet.begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-            entryValuesSendBuff_[peerRank]->wait();
-        }
+        waitSendFinished_();
+#endif // HAVE_MPI
     }
 
     // communicates and copies the contents of overlapping rows from
     // the master
     void syncCopy()
     {
-        // first, send all entries to the peers
-        const PeerSet& peerSet = overlap_->peerSet();
-        typename PeerSet::const_iterator peerIt = peerSet.begin();
-        typename PeerSet::const_iterator peerEndIt = peerSet.end();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-
+#if HAVE_MPI
+        // first, post the receive operations and send all entries to the peers
+        startReceives_();
+        for (const ProcessRank peerRank : peerRanks_)
             sendEntries_(peerRank);
-        }
-
-        // then, receive entries from the peers
-        peerIt = peerSet.begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
 
-            receiveCopyEntries_(peerRank);
+        // then, copy the entries as soon as they are received from a peer
+        for (unsigned i = 0; i < peerRanks_.size(); ++i) {
+            int peerIdx;
+            MPI_Waitany(static_cast<int>(entryValuesRecvRequests_.size()),
+                        entryValuesRecvRequests_.data(),
+                        &peerIdx,
+                        MPI_STATUS_IGNORE);
+            assert(peerIdx != MPI_UNDEFINED);
+            receiveCopyEntries_(peerRanks_[static_cast<unsigned>(peerIdx)]);
         }
 
         // finally, make sure that everything which we send was
         // received by the peers
-        peerIt = peerSet.begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-            entryValuesSendBuff_[peerRank]->wait();
-        }
+        waitSendFinished_();
+#endif // HAVE_MPI
     }
 
 private:
@@ -334,6 +358,44 @@ private:
 
         // communicate the entries
         buildIndices_(nativeMatrix);
+
+        // split the rows into the ones which are seen by some peer process and the
+        // remaining ones
+        overlapRows_.clear();
+        interiorRows_.clear();
+        for (unsigned rowIdx = 0; rowIdx < numDomestic; ++rowIdx) {
+            if (overlap_->isInOverlap(static_cast<Index>(rowIdx)))
+                overlapRows_.push_back(rowIdx);
+            else
+                interiorRows_.push_back(rowIdx);
+        }
+    }
+
+    template <class X, class Y>
+    void mvRows_(const std::vector<unsigned>& rows, const X& x, Y& y) const
+    {
+        for (unsigned rowIdx : rows) {
+            auto& yi = y[rowIdx];
+            yi = 0.0;
+
+            auto colIt = (*this)[rowIdx].begin();
+            const auto& colEndIt = (*this)[rowIdx].end();
+            for (; colIt != colEndIt; ++colIt)
+                (*colIt).umv(x[colIt.index()], yi);
+        }
+    }
+
+    template <class X, class Y>
+    void usmvRows_(const std::vector<unsigned>& rows, field_type alpha, const X& x, Y& y) const
+    {
+        for (unsigned rowIdx : rows) {
+            auto& yi = y[rowIdx];
+
+            auto colIt = (*this)[rowIdx].begin();
+            const auto& colEndIt = (*this)[rowIdx].end();
+            for (; colIt != colEndIt; ++colIt)
+                (*colIt).usmv(alpha, x[colIt.index()], yi);
+        }
     }
 
     template <class NativeBCRSMatrix>
@@ -444,8 +506,46 @@ private:
 
         // free the memory occupied by the array of the matrix entries
         entries_.clear();
+
+        // set up the persistent requests which are used to exchange the values of
+        // the matrix entries
+        setupPersistentRequests_();
     }
 
+    void setupPersistentRequests_()
+    {
+#if HAVE_MPI
+        const PeerSet& peerSet = overlap_->peerSet();
+        peerRanks_.assign(peerSet.begin(), peerSet.end());
+        entryValuesRecvRequests_.resize(peerRanks_.size());
+        for (unsigned peerIdx = 0; peerIdx < peerRanks_.size(); ++peerIdx) {
+            ProcessRank peerRank = peerRanks_[peerIdx];
+
+            entryValuesSendBuff_[peerRank]->setupPersistentSend(peerRank,
+                                                                overlap_->communicator(),
+                                                                entryValuesTag_);
+            entryValuesRecvBuff_[peerRank]->setupPersistentReceive(peerRank,
+                                                                   overlap_->communicator(),
+                                                                   entryValuesTag_);
+            entryValuesRecvRequests_[peerIdx] = entryValuesRecvBuff_[peerRank]->request();
+        }
+#endif // HAVE_MPI
+    }
+
+#if HAVE_MPI
+    void startReceives_()
+    {
+        for (const ProcessRank peerRank : peerRanks_)
+            entryValuesRecvBuff_[peerRank]->start();
+    }
+
+    void waitSendFinished_()
+    {
+        for (const ProcessRank peerRank : peerRanks_)
+            entryValuesSendBuff_[peerRank]->wait();
+    }
+#endif // HAVE_MPI
+
     // send the overlap indices to a peer
     template <class NativeBCRSMatrix>
     void sendIndices_(const NativeBCRSMatrix& nativeMatrix OPM_UNUSED_NOMPI,
@@ -604,7 +704,7 @@ private:
             }
         }
 
-        mpiSendBuff.send(peerRank);
+        mpiSendBuff.start();
 #endif // HAVE_MPI
     }
 
@@ -617,8 +717,6 @@ private:
         auto &mpiRowSizesRecvBuff = *rowSizesRecvBuff_[peerRank];
         auto &mpiColIndicesRecvBuff = *entryColIndicesRecvBuff_[peerRank];
 
-        mpiRecvBuff.receive(peerRank);
-
         // retrieve the values from the receive buffer
         unsigned k = 0;
         for (unsigned i = 0; i < mpiRowIndicesRecvBuff.size(); ++i) {
@@ -645,8 +743,6 @@ private:
         MpiBuffer<unsigned> &mpiRowSizesRecvBuff = *rowSizesRecvBuff_[peerRank];
         MpiBuffer<Index> &mpiColIndicesRecvBuff = *entryColIndicesRecvBuff_[peerRank];
 
-        mpiRecvBuff.receive(peerRank);
-
         // retrieve the values from the receive buffer
         unsigned k = 0;
         for (unsigned i = 0; i < mpiRowIndicesRecvBuff.size(); ++i) {
@@ -670,10 +766,22 @@ private:
             idxBuff[i] = overlap_->globalToDomestic(idxBuff[i]);
     }
 
+    // the MPI tag used to exchange the values of the matrix entries
+    static constexpr int entryValuesTag_ = 2;
+
     int myRank_;
     Entries entries_;
     std::shared_ptr<Overlap> overlap_;
 
+    // the domestic rows which are seen by some peer process and the remaining ones
+    std::vector<unsigned> overlapRows_;
+    std::vector<unsigned> interiorRows_;
+
+    std::vector<ProcessRank> peerRanks_;
+#if HAVE_MPI
+    std::vector<MPI_Request> entryValuesRecvRequests_;
+#endif // HAVE_MPI
+
     std::map<ProcessRank, MpiBuffer<unsigned> *> numRowsSendBuff_;
     std::map<ProcessRank, MpiBuffer<unsigned> *> rowSizesSendBuff_;
     std::map<ProcessRank, MpiBuffer<Index> *> rowIndicesSendBuff_;
@@ -36,7 +36,7 @@
 #include <dune/common/fvector.hh>
 
 #include <memory>
-#include <map>
+#include <vector>
 #include <iostream>
 
 namespace Opm {
@@ -65,11 +65,15 @@ public:
      */
     OverlappingBlockVector(const OverlappingBlockVector& obv)
         : ParentType(obv)
-        , numIndicesSendBuff_(obv.numIndicesSendBuff_)
+        , peerRanks_(obv.peerRanks_)
         , indicesSendBuff_(obv.indicesSendBuff_)
         , indicesRecvBuff_(obv.indicesRecvBuff_)
+        , masterIndicesRecvBuff_(obv.masterIndicesRecvBuff_)
         , valuesSendBuff_(obv.valuesSendBuff_)
         , valuesRecvBuff_(obv.valuesRecvBuff_)
+#if HAVE_MPI
+        , valuesRecvRequests_(obv.valuesRecvRequests_)
+#endif // HAVE_MPI
         , overlap_(obv.overlap_)
     {}
 
@@ -92,11 +96,15 @@ public:
     OverlappingBlockVector& operator=(const OverlappingBlockVector& obv)
     {
         ParentType::operator=(obv);
-        numIndicesSendBuff_ = obv.numIndicesSendBuff_;
+        peerRanks_ = obv.peerRanks_;
         indicesSendBuff_ = obv.indicesSendBuff_;
         indicesRecvBuff_ = obv.indicesRecvBuff_;
+        masterIndicesRecvBuff_ = obv.masterIndicesRecvBuff_;
         valuesSendBuff_ = obv.valuesSendBuff_;
         valuesRecvBuff_ = obv.valuesRecvBuff_;
+#if HAVE_MPI
+        valuesRecvRequests_ = obv.valuesRecvRequests_;
+#endif // HAVE_MPI
         overlap_ = obv.overlap_;
         return *this;
     }
@@ -174,16 +182,46 @@ public:
      */
     void sync()
     {
+        startSync();
+        finishSync();
+    }
+
+    /*!
+     * \brief Start to syncronize the values of the block vector from their master
+     *        process.
+     *
+     * When this method is called, the values of the rows which are seen by peer
+     * processes (i.e., the rows for which DomesticOverlapFromBCRSMatrix::isInOverlap()
+     * is true) must be up to date. Until finishSync() has been called, only the
+     * remaining rows of the vector may be modified.
+     */
+    void startSync()
+    {
+#if HAVE_MPI
+        // post the receive operations before sending anything
+        startReceives_();
+
         // send all entries to all peers
-        for (const auto peerRank: overlap_->peerSet())
-            sendEntries_(peerRank);
+        for (unsigned peerIdx = 0; peerIdx < peerRanks_.size(); ++peerIdx)
+            sendEntries_(peerIdx);
+#endif // HAVE_MPI
+    }
 
-        // recieve all entries to the peers
-        for (const auto peerRank: overlap_->peerSet())
-            receiveFromMaster_(peerRank);
+    /*!
+     * \brief Finish the syncronization which was started by startSync().
+     */
+    void finishSync()
+    {
+#if HAVE_MPI
+        // copy the entries received from the peers as soon as they arrive. since
+        // each entry is only copied from its master rank, the order in which the
+        // peers are processed does not matter.
+        for (unsigned i = 0; i < peerRanks_.size(); ++i)
+            receiveFromMaster_(waitAnyReceive_());
 
         // wait until we have send everything
         waitSendFinished_();
+#endif // HAVE_MPI
     }
 
     /*!
@@ -192,16 +230,25 @@ public:
      */
     void syncAdd()
     {
-        // send all entries to all peers
-        for (const auto peerRank: overlap_->peerSet())
-            sendEntries_(peerRank);
+#if HAVE_MPI
+        // post the receive operations before sending anything
+        startReceives_();
 
-        // recieve all entries to the peers
-        for (const auto peerRank: overlap_->peerSet())
-            receiveAdd_(peerRank);
+        // send all entries to all peers
+        for (unsigned peerIdx = 0; peerIdx < peerRanks_.size(); ++peerIdx)
+            sendEntries_(peerIdx);
+
+        // add up the entries received from the peers. to make the result
+        // independent of the order in which the messages arrive, the peers are
+        // always processed in the same order.
+        for (unsigned peerIdx = 0; peerIdx < peerRanks_.size(); ++peerIdx) {
+            valuesRecvBuff_[peerIdx]->wait();
+            receiveAdd_(peerIdx);
+        }
 
         // wait until we have send everything
         waitSendFinished_();
+#endif // HAVE_MPI
     }
 
     void print() const
@@ -213,42 +260,50 @@ public:
     }
 
 private:
+    // the MPI tag used to exchange the values of overlapping block vectors
+    static constexpr int valuesTag_ = 1;
+
     void createBuffers_()
     {
 #if HAVE_MPI
-        // create array for the front indices
-        typename PeerSet::const_iterator peerIt;
-        typename PeerSet::const_iterator peerEndIt = overlap_->peerSet().end();
+        peerRanks_.assign(overlap_->peerSet().begin(), overlap_->peerSet().end());
+        size_t numPeers = peerRanks_.size();
+
+        indicesSendBuff_.resize(numPeers);
+        indicesRecvBuff_.resize(numPeers);
+        masterIndicesRecvBuff_.resize(numPeers);
+        valuesSendBuff_.resize(numPeers);
+        valuesRecvBuff_.resize(numPeers);
+        valuesRecvRequests_.resize(numPeers);
 
         // send all indices to the peers
-        peerIt = overlap_->peerSet().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
+        std::vector<MpiBuffer<unsigned> > numIndicesSendBuff(numPeers);
+        for (unsigned peerIdx = 0; peerIdx < numPeers; ++peerIdx) {
+            ProcessRank peerRank = peerRanks_[peerIdx];
 
             size_t numEntries = overlap_->foreignOverlapSize(peerRank);
-            numIndicesSendBuff_[peerRank] = std::make_shared<MpiBuffer<unsigned> >(1);
-            indicesSendBuff_[peerRank] = std::make_shared<MpiBuffer<Index> >(numEntries);
-            valuesSendBuff_[peerRank] = std::make_shared<MpiBuffer<FieldVector> >(numEntries);
+            numIndicesSendBuff[peerIdx].resize(1);
+            indicesSendBuff_[peerIdx] = std::make_shared<MpiBuffer<Index> >(numEntries);
+            valuesSendBuff_[peerIdx] = std::make_shared<MpiBuffer<FieldVector> >(numEntries);
 
             // fill the indices buffer with global indices
-            MpiBuffer<Index>& indicesSendBuff = *indicesSendBuff_[peerRank];
+            MpiBuffer<Index>& indicesSendBuff = *indicesSendBuff_[peerIdx];
             for (unsigned i = 0; i < numEntries; ++i) {
                 Index domRowIdx = overlap_->foreignOverlapOffsetToDomesticIdx(peerRank, i);
                 indicesSendBuff[i] = overlap_->domesticToGlobal(domRowIdx);
             }
 
             // first, send the number of indices
-            (*numIndicesSendBuff_[peerRank])[0] = static_cast<unsigned>(numEntries);
-            numIndicesSendBuff_[peerRank]->send(peerRank);
+            numIndicesSendBuff[peerIdx][0] = static_cast<unsigned>(numEntries);
+            numIndicesSendBuff[peerIdx].send(peerRank);
 
             // then, send the indices themselfs
             indicesSendBuff.send(peerRank);
         }
 
         // receive the indices from the peers
-        peerIt = overlap_->peerSet().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
+        for (unsigned peerIdx = 0; peerIdx < numPeers; ++peerIdx) {
+            ProcessRank peerRank = peerRanks_[peerIdx];
 
             // receive size of overlap to peer
             MpiBuffer<unsigned> numRowsRecvBuff(1);
@@ -256,89 +311,115 @@ private:
             unsigned numRows = numRowsRecvBuff[0];
 
             // then, create the MPI buffers
-            indicesRecvBuff_[peerRank] = std::shared_ptr<MpiBuffer<Index> >(
-                new MpiBuffer<Index>(numRows));
-            valuesRecvBuff_[peerRank] = std::shared_ptr<MpiBuffer<FieldVector> >(
-                new MpiBuffer<FieldVector>(numRows));
-            MpiBuffer<Index>& indicesRecvBuff = *indicesRecvBuff_[peerRank];
+            indicesRecvBuff_[peerIdx] = std::make_shared<MpiBuffer<Index> >(numRows);
+            masterIndicesRecvBuff_[peerIdx] = std::make_shared<MpiBuffer<Index> >(numRows);
+            valuesRecvBuff_[peerIdx] = std::make_shared<MpiBuffer<FieldVector> >(numRows);
+            MpiBuffer<Index>& indicesRecvBuff = *indicesRecvBuff_[peerIdx];
+            MpiBuffer<Index>& masterIndicesRecvBuff = *masterIndicesRecvBuff_[peerIdx];
 
             // next, receive the actual indices
             indicesRecvBuff.receive(peerRank);
 
-            // finally, translate the global indices to domestic ones
+            // finally, translate the global indices to domestic ones. for the
+            // synchronization from the master ranks, we only consider the rows for
+            // which the peer is the master.
             for (unsigned i = 0; i != numRows; ++i) {
                 Index globalRowIdx = indicesRecvBuff[i];
                 Index domRowIdx = overlap_->globalToDomestic(globalRowIdx);
 
                 indicesRecvBuff[i] = domRowIdx;
+                if (overlap_->masterRank(domRowIdx) == peerRank)
+                    masterIndicesRecvBuff[i] = domRowIdx;
+                else
+                    masterIndicesRecvBuff[i] = -1;
             }
         }
 
         // wait for all send operations to complete
-        peerIt = overlap_->peerSet().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-            numIndicesSendBuff_[peerRank]->wait();
-            indicesSendBuff_[peerRank]->wait();
+        for (unsigned peerIdx = 0; peerIdx < numPeers; ++peerIdx) {
+            numIndicesSendBuff[peerIdx].wait();
+            indicesSendBuff_[peerIdx]->wait();
 
             // convert the global indices of the send buffer to
             // domestic ones
-            MpiBuffer<Index>& indicesSendBuff = *indicesSendBuff_[peerRank];
+            MpiBuffer<Index>& indicesSendBuff = *indicesSendBuff_[peerIdx];
             for (unsigned i = 0; i < indicesSendBuff.size(); ++i) {
                 indicesSendBuff[i] = overlap_->globalToDomestic(indicesSendBuff[i]);
             }
         }
+
+        // the communication pattern does not change anymore, so we can set up
+        // persistent requests for exchanging the values
+        for (unsigned peerIdx = 0; peerIdx < numPeers; ++peerIdx) {
+            ProcessRank peerRank = peerRanks_[peerIdx];
+            valuesSendBuff_[peerIdx]->setupPersistentSend(peerRank,
+                                                          overlap_->communicator(),
+                                                          valuesTag_);
+            valuesRecvBuff_[peerIdx]->setupPersistentReceive(peerRank,
+                                                             overlap_->communicator(),
+                                                             valuesTag_);
+            valuesRecvRequests_[peerIdx] = valuesRecvBuff_[peerIdx]->request();
+        }
 #endif // HAVE_MPI
     }
 
-    void sendEntries_(ProcessRank peerRank)
+#if HAVE_MPI
+    void startReceives_()
+    {
+        for (unsigned peerIdx = 0; peerIdx < peerRanks_.size(); ++peerIdx)
+            valuesRecvBuff_[peerIdx]->start();
+    }
+
+    // wait until the values of any peer have been received and return the index of
+    // the peer.
+    unsigned waitAnyReceive_()
+    {
+        // note that the requests are persistent, i.e., MPI_Waitany() does not
+        // deallocate them but only marks them as inactive.
+        int peerIdx;
+        MPI_Waitany(static_cast<int>(valuesRecvRequests_.size()),
+                    valuesRecvRequests_.data(),
+                    &peerIdx,
+                    MPI_STATUS_IGNORE);
+        assert(peerIdx != MPI_UNDEFINED);
+        return static_cast<unsigned>(peerIdx);
+    }
+
+    void sendEntries_(unsigned peerIdx)
     {
         // copy the values into the send buffer
-        const MpiBuffer<Index>& indices = *indicesSendBuff_[peerRank];
-        MpiBuffer<FieldVector>& values = *valuesSendBuff_[peerRank];
+        const MpiBuffer<Index>& indices = *indicesSendBuff_[peerIdx];
+        MpiBuffer<FieldVector>& values = *valuesSendBuff_[peerIdx];
         for (unsigned i = 0; i < indices.size(); ++i)
             values[i] = (*this)[static_cast<unsigned>(indices[i])];
 
-        values.send(peerRank);
+        values.start();
     }
 
     void waitSendFinished_()
     {
-        typename PeerSet::const_iterator peerIt;
-        typename PeerSet::const_iterator peerEndIt = overlap_->peerSet().end();
-
-        // send all entries to all peers
-        peerIt = overlap_->peerSet().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-            valuesSendBuff_[peerRank]->wait();
-        }
+        for (unsigned peerIdx = 0; peerIdx < peerRanks_.size(); ++peerIdx)
+            valuesSendBuff_[peerIdx]->wait();
     }
 
-    void receiveFromMaster_(ProcessRank peerRank)
+    void receiveFromMaster_(unsigned peerIdx)
     {
-        const MpiBuffer<Index>& indices = *indicesRecvBuff_[peerRank];
-        MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerRank];
-
-        // receive the values from the peer
-        values.receive(peerRank);
+        const MpiBuffer<Index>& indices = *masterIndicesRecvBuff_[peerIdx];
+        const MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerIdx];
 
-        // copy them into the block vector
+        // copy the values of the rows for which the peer is the master into the
+        // block vector
         for (unsigned j = 0; j < indices.size(); ++j) {
             Index domRowIdx = indices[j];
-            if (overlap_->masterRank(domRowIdx) == peerRank) {
+            if (domRowIdx >= 0)
                 (*this)[static_cast<unsigned>(domRowIdx)] = values[j];
-            }
         }
     }
 
-    void receiveAdd_(ProcessRank peerRank)
+    void receiveAdd_(unsigned peerIdx)
     {
-        const MpiBuffer<Index>& indices = *indicesRecvBuff_[peerRank];
-        MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerRank];
-
-        // receive the values from the peer
-        values.receive(peerRank);
+        const MpiBuffer<Index>& indices = *indicesRecvBuff_[peerIdx];
+        const MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerIdx];
 
         // add up the values of rows on the shared boundary
         for (unsigned j = 0; j < indices.size(); ++j) {
@@ -346,12 +427,20 @@ private:
             (*this)[static_cast<unsigned>(domRowIdx)] += values[j];
         }
     }
+#endif // HAVE_MPI
 
-    std::map<ProcessRank, std::shared_ptr<MpiBuffer<unsigned> > > numIndicesSendBuff_;
-    std::map<ProcessRank, std::shared_ptr<MpiBuffer<Index> > > indicesSendBuff_;
-    std::map<ProcessRank, std::shared_ptr<MpiBuffer<Index> > > indicesRecvBuff_;
-    std::map<ProcessRank, std::shared_ptr<MpiBuffer<FieldVector> > > valuesSendBuff_;
-    std::map<ProcessRank, std::shared_ptr<MpiBuffer<FieldVector> > > valuesRecvBuff_;
+    // the communication plan of the vector. The buffers are shared by all copies
+    // of the vector and the entries of all vectors correspond to the entries of
+    // peerRanks_.
+    std::vector<ProcessRank> peerRanks_;
+    std::vector<std::shared_ptr<MpiBuffer<Index> > > indicesSendBuff_;
+    std::vector<std::shared_ptr<MpiBuffer<Index> > > indicesRecvBuff_;
+    std::vector<std::shared_ptr<MpiBuffer<Index> > > masterIndicesRecvBuff_;
+    std::vector<std::shared_ptr<MpiBuffer<FieldVector> > > valuesSendBuff_;
+    std::vector<std::shared_ptr<MpiBuffer<FieldVector> > > valuesRecvBuff_;
+#if HAVE_MPI
+    std::vector<MPI_Request> valuesRecvRequests_;
+#endif // HAVE_MPI
 
     const Overlap *overlap_;
 };
@@ -57,16 +57,32 @@ public:
     //! apply operator to x:  \f$ y = A(x) \f$
     virtual void apply(const DomainVector& x, RangeVector& y) const override
     {
-        A_.mv(x, y);
-        y.sync();
+        if (overlap().peerSet().empty()) {
+            A_.mv(x, y);
+            return;
+        }
+
+        // compute the rows which are seen by the peer processes first, so that their
+        // communication can be overlapped with the computation of the interior rows
+        A_.mvOverlap(x, y);
+        y.startSync();
+        A_.mvInterior(x, y);
+        y.finishSync();
     }
 
     //! apply operator to x, scale and add:  \f$ y = y + \alpha A(x) \f$
     virtual void applyscaleadd(field_type alpha, const DomainVector& x,
                                RangeVector& y) const override
     {
-        A_.usmv(alpha, x, y);
-        y.sync();
+        if (overlap().peerSet().empty()) {
+            A_.usmv(alpha, x, y);
+            return;
+        }
+
+        A_.usmvOverlap(alpha, x, y);
+        y.startSync();
+        A_.usmvInterior(alpha, x, y);
+        y.finishSync();
     }
 
     //! returns the matrix
@@ -31,11 +31,16 @@
 #include <dune/common/parallel/mpihelper.hh>
 #include <dune/istl/scalarproducts.hh>
 
+#include <opm/models/parallel/reproduciblesum.hh>
+
 namespace Opm {
 namespace Linear {
 
 /*!
  * \brief An overlap aware ISTL scalar product.
+ *
+ * If reproducible sums are requested, the dot product is computed exactly using
+ * Opm::ReproducibleSum, i.e., its result does not depend on the number of processes.
  */
 template <class OverlappingBlockVector, class Overlap>
 class OverlappingScalarProduct
@@ -51,8 +56,9 @@ public:
     Dune::SolverCategory::Category category() const override
     { return Dune::SolverCategory::overlapping; }
 
-    OverlappingScalarProduct(const Overlap& overlap)
+    OverlappingScalarProduct(const Overlap& overlap, bool reproducible = false)
         : overlap_(overlap), comm_( Dune::MPIHelper::getCollectiveCommunication() )
+        , reproducible_(reproducible)
     {}
 
 #if DUNE_VERSION_NEWER(DUNE_ISTL, 2,7)
@@ -63,13 +69,24 @@ public:
                    const OverlappingBlockVector& y) override
 #endif
     {
-        field_type sum = 0;
-        size_t numLocal = overlap_.numLocal();
-        for (unsigned localIdx = 0; localIdx < numLocal; ++localIdx) {
-            if (overlap_.iAmMasterOf(static_cast<int>(localIdx)))
-                sum += x[localIdx] * y[localIdx];
+        // the indices for which the current process is the master are
+        // the first ones of the domestic indices
+        size_t numMaster = overlap_.numMaster();
+
+        if (reproducible_) {
+            ReproducibleSum exactSum;
+            for (unsigned localIdx = 0; localIdx < numMaster; ++localIdx)
+                for (unsigned i = 0; i < x[localIdx].size(); ++i)
+                    exactSum += x[localIdx][i] * y[localIdx][i];
+
+            exactSum.sumOverProcesses(comm_);
+            return exactSum.value();
         }
 
+        field_type sum = 0;
+        for (unsigned localIdx = 0; localIdx < numMaster; ++localIdx)
+            sum += x[localIdx] * y[localIdx];
+
         // return the global sum
         return comm_.sum( sum );
     }
@@ -84,6 +101,7 @@ public:
 private:
     const Overlap& overlap_;
     const CollectiveCommunication comm_;
+    bool reproducible_;
 };
 
 } // namespace Linear
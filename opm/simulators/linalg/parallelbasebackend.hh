@@ -46,9 +46,11 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/version.hh>
 
+#include <cmath>
 #include <sstream>
 #include <memory>
 #include <iostream>
+#include <type_traits>
 
 BEGIN_PROPERTIES
 NEW_TYPE_TAG(ParallelBaseLinearSolver);
@@ -68,6 +70,7 @@ NEW_PROP_TAG(OverlappingVector);
 NEW_PROP_TAG(OverlappingMatrix);
 NEW_PROP_TAG(OverlappingScalarProduct);
 NEW_PROP_TAG(OverlappingLinearOperator);
+NEW_PROP_TAG(EnableReproducibleSums);
 
 //! The type of the linear solver to be used
 NEW_PROP_TAG(LinearSolverBackend);
@@ -107,6 +110,16 @@ NEW_PROP_TAG(LinearSolverAbsTolerance);
  */
 NEW_PROP_TAG(LinearSolverVerbosity);
 
+/*!
+ * \brief Specifies whether the rows of the linear system of equations ought to be
+ *        premultiplied by the inverses of their diagonal blocks before solving it.
+ *
+ * This makes the equations of a degree of freedom dimensionless with respect to each
+ * other, which usually improves the convergence of ILU and AMG preconditioners if the
+ * magnitudes of the conservation equations differ widely.
+ */
+NEW_PROP_TAG(LinearSolverScaleBlockDiagonal);
+
 //! Maximum number of iterations eyecuted by the linear solver
 NEW_PROP_TAG(LinearSolverMaxIterations);
 
@@ -116,6 +129,12 @@ NEW_PROP_TAG(PreconditionerOrder);
 //! The relaxation factor of the preconditioner
 NEW_PROP_TAG(PreconditionerRelaxation);
 
+//! The index of the pressure primary variable for the CPR preconditioner
+NEW_PROP_TAG(CprPressureVarIdx);
+
+//! The coarsening target of the AMG for the pressure system of the CPR preconditioner
+NEW_PROP_TAG(CprAmgCoarsenTarget);
+
 //! Set the type of a global jacobian matrix for linear solvers that are based on
 //! dune-istl.
 SET_PROP(ParallelBaseLinearSolver, SparseMatrixAdapter)
@@ -158,6 +177,9 @@ namespace Linear {
  *            that it is computationally cheaper because it does not
  *            need to consider things which are only required for
  *            higher orders
+ * - \c Cpr: A two-stage constrained pressure residual preconditioner which
+ *            corrects the pressure using an AMG on a quasi-IMPES pressure
+ *            system and then applies ILU(0) to the full system
  */
 template <class TypeTag>
 class ParallelBaseBackend
@@ -182,9 +204,7 @@ protected:
 
     typedef Opm::Linear::OverlappingPreconditioner<SequentialPreconditioner, Overlap> ParallelPreconditioner;
     typedef Opm::Linear::OverlappingScalarProduct<OverlappingVector, Overlap> ParallelScalarProduct;
-    typedef Opm::Linear::OverlappingOperator<OverlappingMatrix,
-                                             OverlappingVector,
-                                             OverlappingVector> ParallelOperator;
+    typedef typename GET_PROP_TYPE(TypeTag, OverlappingLinearOperator) ParallelOperator;
 
     enum { dimWorld = GridView::dimensionworld };
 
@@ -217,6 +237,9 @@ public:
                              "The maximum number of iterations of the linear solver");
         EWOMS_REGISTER_PARAM(TypeTag, int, LinearSolverVerbosity,
                              "The verbosity level of the linear solver");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, LinearSolverScaleBlockDiagonal,
+                             "Premultiply each row of the linear system by the inverse "
+                             "of its diagonal block before solving it");
 
         PreconditionerWrapper::registerParameters();
     }
@@ -313,16 +336,20 @@ public:
 
         (*overlappingx_) = 0.0;
 
+        if (EWOMS_GET_PARAM(TypeTag, bool, LinearSolverScaleBlockDiagonal))
+            asImp_().scaleBlockDiagonal_();
+
         auto parPreCond = asImp_().preparePreconditioner_();
         auto precondCleanupFn = [this]() -> void
                                 { this->asImp_().cleanupPreconditioner_(); };
         auto precondCleanupGuard = Opm::make_guard(precondCleanupFn);
         // create the parallel scalar product and the parallel operator
-        ParallelScalarProduct parScalarProduct(overlappingMatrix_->overlap());
-        ParallelOperator parOperator(*overlappingMatrix_);
+        ParallelScalarProduct parScalarProduct(overlappingMatrix_->overlap(),
+                                               EWOMS_GET_PARAM(TypeTag, bool, EnableReproducibleSums));
+        auto parOperator = asImp_().prepareOperator_();
 
         // retrieve the linear solver
-        auto solver = asImp_().prepareSolver_(parOperator,
+        auto solver = asImp_().prepareSolver_(*parOperator,
                                               parScalarProduct,
                                               *parPreCond);
 
@@ -397,6 +424,66 @@ protected:
         precWrapper_.cleanup();
     }
 
+    std::shared_ptr<ParallelOperator> prepareOperator_()
+    { return createOperator_(std::is_constructible<ParallelOperator, const OverlappingMatrix&>()); }
+
+    // linear operators which only need the assembled matrix
+    std::shared_ptr<ParallelOperator> createOperator_(std::true_type)
+    { return std::make_shared<ParallelOperator>(*overlappingMatrix_); }
+
+    // linear operators which also need to evaluate the model, e.g. matrix-free ones
+    std::shared_ptr<ParallelOperator> createOperator_(std::false_type)
+    { return std::make_shared<ParallelOperator>(*overlappingMatrix_, simulator_); }
+
+    /*!
+     * \brief Premultiply each row of the overlapping matrix and of the overlapping
+     *        right hand side by the inverse of the row's diagonal block.
+     *
+     * This does not change the solution of the linear system. Since the rows of the
+     * overlapping matrix are identical on all processes which see them, no
+     * communication is required. Rows with singular diagonal blocks are left
+     * alone. Note that this modifies the internal copies of the matrix and of the
+     * residual, i.e., setMatrix() and setResidual() must be called before the next
+     * solve.
+     */
+    void scaleBlockDiagonal_()
+    {
+        typedef typename OverlappingMatrix::block_type MatrixBlock;
+
+        auto& M = *overlappingMatrix_;
+        auto& b = *overlappingb_;
+        size_t numRows = M.N();
+        for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            auto& row = M[rowIdx];
+            auto diagIt = row.find(rowIdx);
+            if (diagIt == row.end())
+                continue;
+
+            MatrixBlock diagInv(*diagIt);
+            try {
+                diagInv.invert();
+            }
+            catch (const Dune::FMatrixError&) {
+                continue;
+            }
+
+            bool isFinite = true;
+            for (int i = 0; i < MatrixBlock::rows && isFinite; ++i)
+                for (int j = 0; j < MatrixBlock::cols; ++j)
+                    isFinite = isFinite && std::isfinite(diagInv[i][j]);
+            if (!isFinite)
+                continue;
+
+            auto colIt = row.begin();
+            const auto& colEndIt = row.end();
+            for (; colIt != colEndIt; ++colIt)
+                colIt->leftmultiply(diagInv);
+
+            auto tmp = b[rowIdx];
+            diagInv.mv(tmp, b[rowIdx]);
+        }
+    }
+
     void writeOverlapToVTK_()
     {
         for (int lookedAtRank = 0;
@@ -457,6 +544,16 @@ SET_SCALAR_PROP(ParallelBaseLinearSolver, PreconditionerRelaxation, 1.0);
 //! set the preconditioner order to 0 by default
 SET_INT_PROP(ParallelBaseLinearSolver, PreconditionerOrder, 0);
 
+//! do not scale the linear system by default
+SET_BOOL_PROP(ParallelBaseLinearSolver, LinearSolverScaleBlockDiagonal, false);
+
+//! let the CPR preconditioner determine the index of the pressure primary variable
+//! from the model's indices by default
+SET_INT_PROP(ParallelBaseLinearSolver, CprPressureVarIdx, -1);
+
+//! the coarsening target for the AMG of the pressure system of the CPR preconditioner
+SET_INT_PROP(ParallelBaseLinearSolver, CprAmgCoarsenTarget, 1200);
+
 //! by default use the same kind of floating point values for the linearization and for
 //! the linear solve
 SET_TYPE_PROP(ParallelBaseLinearSolver,
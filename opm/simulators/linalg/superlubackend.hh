@@ -29,15 +29,27 @@
 
 #if HAVE_SUPERLU
 
-#include <opm/models/linear/istlsparsematrixbackend.hh>
+#include <opm/simulators/linalg/istlsparsematrixadapter.hh>
+#include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/parametersystem.hh>
 
 #include <opm/material/common/Unused.hpp>
 
 #include <dune/istl/superlu.hh>
+#include <dune/istl/solvers.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioner.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/istlexception.hh>
 #include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
 #include <dune/common/version.hh>
 
+#include <cmath>
+#include <iostream>
+#include <memory>
+
 BEGIN_PROPERTIES
 
 // forward declaration of the required property tags
@@ -47,19 +59,94 @@ NEW_PROP_TAG(Simulator);
 NEW_PROP_TAG(SparseMatrixAdapter);
 NEW_PROP_TAG(GlobalEqVector);
 NEW_PROP_TAG(LinearSolverVerbosity);
+NEW_PROP_TAG(LinearSolverTolerance);
 NEW_PROP_TAG(LinearSolverBackend);
+
+/*!
+ * \brief The number of solves for which the LU factorization of a previous linear
+ *        system is used as the preconditioner of an iterative solver.
+ *
+ * A value of 0 means that each linear system is factorized.
+ */
+NEW_PROP_TAG(LinearSolverMaxFactorizationReuse);
+
 NEW_TYPE_TAG(SuperLULinearSolver);
 
 END_PROPERTIES
 
 namespace Opm {
 namespace Linear {
-template <class Scalar, class TypeTag, class Matrix, class Vector>
-class SuperLUSolve_;
+/*!
+ * \ingroup Linear
+ * \brief Preconditioner which applies the LU factorization of a linear system that was
+ *        computed by SuperLU.
+ *
+ * The factorization does not need to stem from the linear system which is to be
+ * solved. Since SuperLU can deal with at most double precision and requires the
+ * blocks of the matrix to be Dune::FieldMatrix objects, the vectors are converted.
+ */
+template <class Vector, class LuSolver, class LuVector>
+class SuperLUFactorizationPreconditioner : public Dune::Preconditioner<Vector, Vector>
+{
+public:
+    typedef Vector domain_type;
+    typedef Vector range_type;
+    typedef typename Vector::field_type field_type;
+
+    SuperLUFactorizationPreconditioner(LuSolver& luSolver)
+        : luSolver_(luSolver)
+    {}
+
+    //! the kind of computations supported by the preconditioner
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::sequential; }
+
+    void pre(Vector& x OPM_UNUSED, Vector& b OPM_UNUSED) override
+    {}
+
+    void apply(Vector& v, const Vector& d) override
+    { solve(v, d); }
+
+    /*!
+     * \brief Apply the factorization and return true if SuperLU succeeded.
+     */
+    bool solve(Vector& v, const Vector& d)
+    {
+        d_.resize(d.size());
+        v_.resize(v.size());
+        for (unsigned i = 0; i < d.size(); ++i)
+            for (unsigned j = 0; j < d[i].size(); ++j)
+                d_[i][j] = static_cast<double>(d[i][j]);
+
+        Dune::InverseOperatorResult result;
+        luSolver_.apply(v_, d_, result);
+
+        for (unsigned i = 0; i < v.size(); ++i)
+            for (unsigned j = 0; j < v[i].size(); ++j)
+                v[i][j] = v_[i][j];
+
+        return result.converged;
+    }
+
+    void post(Vector& x OPM_UNUSED) override
+    {}
+
+private:
+    LuSolver& luSolver_;
+    LuVector d_;
+    LuVector v_;
+};
 
 /*!
  * \ingroup Linear
  * \brief A linear solver backend for the SuperLU sparse matrix library.
+ *
+ * The backend keeps the SuperLU solver object and a copy of the matrix in the format
+ * required by SuperLU across solves, so the sparsity pattern of the copy is only set
+ * up after the structure of the linear system has changed. Optionally, the LU
+ * factorization can be reused as the preconditioner of a BiCGSTAB solver for the
+ * linear systems of the next few Newton iterations. If this solver fails to
+ * converge, the current linear system gets factorized.
  */
 template <class TypeTag>
 class SuperLUBackend
@@ -67,32 +154,59 @@ class SuperLUBackend
     typedef typename GET_PROP_TYPE(TypeTag, Scalar) Scalar;
     typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
     typedef typename GET_PROP_TYPE(TypeTag, SparseMatrixAdapter) SparseMatrixAdapter;
-    typedef typename SparseMatrixAdapter::block_type Matrix;
+    typedef typename GET_PROP_TYPE(TypeTag, GlobalEqVector) Vector;
+    typedef typename SparseMatrixAdapter::IstlMatrix Matrix;
+
+    enum { numEq = GET_PROP_VALUE(TypeTag, NumEq) };
 
-    static_assert(std::is_same<SparseMatrixAdapter, IstlSparseMatrixAdapter<MatrixBlock>::value,
-                  "The SuperLU linear solver backend requires the IstlSparseMatrixAdapter");
+    // SuperLU can handle at most double precision and requires the blocks of the
+    // matrix to be Dune::FieldMatrix objects, so the linear system is copied.
+    typedef Dune::FieldVector<double, numEq> LuVectorBlock;
+    typedef Dune::FieldMatrix<double, numEq, numEq> LuMatrixBlock;
+    typedef Dune::BlockVector<LuVectorBlock> LuVector;
+    typedef Dune::BCRSMatrix<LuMatrixBlock> LuMatrix;
+    typedef Dune::SuperLU<LuMatrix> LuSolver;
+
+    typedef SuperLUFactorizationPreconditioner<Vector, LuSolver, LuVector> Preconditioner;
 
 public:
     SuperLUBackend(Simulator& simulator OPM_UNUSED)
+        : M_(0)
+        , b_(0)
+        , numReuses_(0)
     {}
 
     static void registerParameters()
     {
         EWOMS_REGISTER_PARAM(TypeTag, int, LinearSolverVerbosity,
                              "The verbosity level of the linear solver");
+        EWOMS_REGISTER_PARAM(TypeTag, unsigned, LinearSolverMaxFactorizationReuse,
+                             "The number of linear solves for which the LU factorization "
+                             "of a previous linear system is used as preconditioner");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, LinearSolverTolerance,
+                             "The residual reduction required for linear solves which "
+                             "reuse a previous LU factorization");
     }
 
     /*!
      * \brief Causes the solve() method to discared the structure of the linear system of
      *        equations the next time it is called.
-     *
-     * Since the SuperLU backend does not create any internal matrices, this is a no-op.
      */
     void eraseMatrix()
-    { }
+    {
+        luSolver_.reset();
+        luMatrix_.reset();
+        numReuses_ = 0;
+    }
 
-    void prepare(const SparseMatrixAdapter& M, const Vector& b)
-    { }
+    void prepare(const SparseMatrixAdapter& M, const Vector& b OPM_UNUSED)
+    {
+        const Matrix& A = M.istlMatrix();
+        if (!hasLuMatrixPattern_(A)) {
+            eraseMatrix();
+            createLuMatrix_(A);
+        }
+    }
 
     void setResidual(const Vector& b)
     { b_ = &b; }
@@ -101,30 +215,24 @@ public:
     { b = *b_; }
 
     void setMatrix(const SparseMatrixAdapter& M)
-    { M_ = &M; }
+    { M_ = &M.istlMatrix(); }
 
     bool solve(Vector& x)
-    { return SuperLUSolve_<Scalar, TypeTag, Matrix, Vector>::solve_(*M_, x, *b_); }
-
-private:
-    const Matrix* M_;
-    Vector* b_;
-};
-
-template <class Scalar, class TypeTag, class Matrix, class Vector>
-class SuperLUSolve_
-{
-public:
-    static bool solve_(const Matrix& A, Vector& x, const Vector& b)
     {
-        Vector bTmp(b);
+        unsigned maxReuse = EWOMS_GET_PARAM(TypeTag, unsigned, LinearSolverMaxFactorizationReuse);
 
-        int verbosity = EWOMS_GET_PARAM(TypeTag, int, LinearSolverVerbosity);
-        Dune::InverseOperatorResult result;
-        Dune::SuperLU<Matrix> solver(A, verbosity > 0);
-        solver.apply(x, bTmp, result);
+        bool converged = false;
+        if (luSolver_ && numReuses_ < maxReuse) {
+            ++numReuses_;
+            converged = solveWithOldFactorization_(x);
+        }
 
-        if (result.converged) {
+        if (!converged) {
+            factorize_();
+            converged = solveDirectly_(x);
+        }
+
+        if (converged) {
             // make sure that the result only contains finite values.
             Scalar tmp = 0;
             for (unsigned i = 0; i < x.size(); ++i) {
@@ -132,49 +240,129 @@ public:
                 for (unsigned j = 0; j < Vector::block_type::dimension; ++j)
                     tmp += xi[j];
             }
-            result.converged = std::isfinite(tmp);
+            converged = std::isfinite(tmp);
         }
 
-        return result.converged;
+        // do not reuse a factorization which did not yield a usable solution
+        if (!converged) {
+            luSolver_.reset();
+            numReuses_ = 0;
+        }
+
+        return converged;
     }
-};
 
-// the following is required to make the SuperLU adapter of dune-istl happy with
-// quadruple precision math on Dune 2.4. this is because the most which SuperLU can
-// handle is double precision (i.e., the linear systems of equations are always solved
-// with at most double precision if chosing SuperLU as the linear solver...)
-#if HAVE_QUAD
-template <class TypeTag, class Matrix, class Vector>
-class SuperLUSolve_<__float128, TypeTag, Matrix, Vector>
-{
-public:
-    static bool solve_(const Matrix& A,
-                       Vector& x,
-                       const Vector& b)
+private:
+    // returns true if the copy of the matrix used by SuperLU exhibits the same sparsity
+    // pattern as a given matrix
+    bool hasLuMatrixPattern_(const Matrix& A) const
+    {
+        if (!luMatrix_ || luMatrix_->N() != A.N() || luMatrix_->M() != A.M()
+            || luMatrix_->nonzeroes() != A.nonzeroes())
+            return false;
+
+        auto luRowIt = luMatrix_->begin();
+        auto rowIt = A.begin();
+        const auto& rowEndIt = A.end();
+        for (; rowIt != rowEndIt; ++rowIt, ++luRowIt) {
+            if (rowIt->size() != luRowIt->size())
+                return false;
+
+            auto luColIt = luRowIt->begin();
+            auto colIt = rowIt->begin();
+            const auto& colEndIt = rowIt->end();
+            for (; colIt != colEndIt; ++colIt, ++luColIt)
+                if (colIt.index() != luColIt.index())
+                    return false;
+        }
+
+        return true;
+    }
+
+    void createLuMatrix_(const Matrix& A)
+    {
+        luMatrix_.reset(new LuMatrix(A.N(), A.M(), A.nonzeroes(), LuMatrix::row_wise));
+        auto rowIt = luMatrix_->createbegin();
+        const auto& rowEndIt = luMatrix_->createend();
+        for (; rowIt != rowEndIt; ++rowIt) {
+            const auto& srcRow = A[rowIt.index()];
+            auto colIt = srcRow.begin();
+            const auto& colEndIt = srcRow.end();
+            for (; colIt != colEndIt; ++colIt)
+                rowIt.insert(colIt.index());
+        }
+    }
+
+    // copy the values of the current matrix and compute its LU factorization
+    void factorize_()
+    {
+        const Matrix& A = *M_;
+        auto luRowIt = luMatrix_->begin();
+        auto rowIt = A.begin();
+        const auto& rowEndIt = A.end();
+        for (; rowIt != rowEndIt; ++rowIt, ++luRowIt) {
+            auto luColIt = luRowIt->begin();
+            auto colIt = rowIt->begin();
+            const auto& colEndIt = rowIt->end();
+            for (; colIt != colEndIt; ++colIt, ++luColIt)
+                for (unsigned i = 0; i < numEq; ++i)
+                    for (unsigned j = 0; j < numEq; ++j)
+                        (*luColIt)[i][j] = static_cast<double>((*colIt)[i][j]);
+        }
+
+        int verbosity = EWOMS_GET_PARAM(TypeTag, int, LinearSolverVerbosity);
+        if (!luSolver_)
+            luSolver_.reset(new LuSolver(*luMatrix_, verbosity > 0));
+        else
+            luSolver_->setMatrix(*luMatrix_);
+
+        numReuses_ = 0;
+    }
+
+    bool solveDirectly_(Vector& x)
     {
-        static const int numEq = GET_PROP_VALUE(TypeTag, NumEq);
-        typedef Dune::FieldVector<double, numEq> DoubleEqVector;
-        typedef Dune::FieldMatrix<double, numEq, numEq> DoubleEqMatrix;
-        typedef Dune::BlockVector<DoubleEqVector> DoubleVector;
-        typedef Dune::BCRSMatrix<DoubleEqMatrix> DoubleMatrix;
-
-        // copy the inputs into the double precision data structures
-        DoubleVector bDouble(b);
-        DoubleVector xDouble(x);
-        DoubleMatrix ADouble(A);
-
-        bool res =
-            SuperLUSolve_<double, TypeTag, Matrix, Vector>::solve_(ADouble,
-                                                                   xDouble,
-                                                                   bDouble);
-
-        // copy the result back into the quadruple precision vector.
-        x = xDouble;
-
-        return res;
+        // SuperLU reports failures, e.g. for singular matrices, via the result
+        Preconditioner precond(*luSolver_);
+        return precond.solve(x, *b_);
+    }
+
+    bool solveWithOldFactorization_(Vector& x)
+    {
+        // the maximum number of iterations. if more are required, it is cheaper to
+        // factorize the current linear system.
+        static const int maxIterations = 20;
+
+        int verbosity = EWOMS_GET_PARAM(TypeTag, int, LinearSolverVerbosity);
+        Scalar tolerance = EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverTolerance);
+
+        Dune::MatrixAdapter<Matrix, Vector, Vector> op(*M_);
+        Preconditioner precond(*luSolver_);
+        Dune::BiCGSTABSolver<Vector> solver(op, precond, tolerance, maxIterations, verbosity);
+
+        Vector bTmp(*b_);
+        Dune::InverseOperatorResult result;
+        x = 0.0;
+        try {
+            solver.apply(x, bTmp, result);
+        }
+        catch (const Dune::ISTLError& e) {
+            // BiCGSTAB throws Dune::SolverAbort if it breaks down. in this case, the
+            // system is solved using a fresh factorization
+            if (verbosity > 0)
+                std::cout << "BiCGSTAB using the old factorization failed: " << e.what() << "\n";
+            return false;
+        }
+
+        return result.converged;
     }
+
+    const Matrix* M_;
+    const Vector* b_;
+
+    std::unique_ptr<LuMatrix> luMatrix_;
+    std::unique_ptr<LuSolver> luSolver_;
+    unsigned numReuses_;
 };
-#endif
 
 } // namespace Linear
 } // namespace Opm
@@ -182,6 +370,8 @@ public:
 BEGIN_PROPERTIES
 
 SET_INT_PROP(SuperLULinearSolver, LinearSolverVerbosity, 0);
+SET_SCALAR_PROP(SuperLULinearSolver, LinearSolverTolerance, 1e-9);
+SET_INT_PROP(SuperLULinearSolver, LinearSolverMaxFactorizationReuse, 0);
 SET_TYPE_PROP(SuperLULinearSolver, LinearSolverBackend,
               Opm::Linear::SuperLUBackend<TypeTag>);
 
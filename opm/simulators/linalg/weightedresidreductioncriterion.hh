@@ -251,26 +251,27 @@ public:
     }
 
 private:
-    // update the weighted absolute residual
+    // update the weighted absolute residual and the difference to the last
+    // solution. both are determined by a single sweep (which also updates the last
+    // solution) and a single collective communication.
     void updateErrors_(const Vector& curSol, const Vector& curResid)
     {
-        residualError_ = 0.0;
-        fixPointError_ = 0.0;
-        for (size_t i = 0; i < curResid.size(); ++i) {
-            for (unsigned j = 0; j < BlockType::dimension; ++j) {
-                residualError_ =
-                    std::max<Scalar>(residualError_,
-                                     residualWeight(i, j)*std::abs(curResid[i][j]));
-                fixPointError_ =
-                    std::max<Scalar>(fixPointError_,
-                                     std::abs(curSol[i][j] - lastSolVec_[i][j])
-                                     /std::max<Scalar>(1.0, curSol[i][j]));
-            }
-        }
-        lastSolVec_ = curSol;
-
-        residualError_ = comm_.max(residualError_);
-        fixPointError_ = comm_.max(fixPointError_);
+        auto weightFn =
+            [this](size_t i, unsigned j) -> Scalar
+            { return this->residualWeight(i, j); };
+        auto updateFn =
+            [this, &curSol](size_t i, unsigned j) -> Scalar
+            {
+                Scalar& lastSol = this->lastSolVec_[i][j];
+                Scalar delta = std::abs(curSol[i][j] - lastSol)/std::max<Scalar>(1.0, curSol[i][j]);
+                lastSol = curSol[i][j];
+                return delta;
+            };
+
+        const auto& norms = computeConvergenceNorms(curResid, weightFn, updateFn, comm_);
+
+        residualError_ = norms.weightedResidual;
+        fixPointError_ = norms.update;
     }
 
     const CollectiveCommunication& comm_;
@@ -0,0 +1,141 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Common code of the tests which compare different ways to linearize the lens
+ *        problem.
+ */
+#ifndef EWOMS_LENS_LINEARIZATION_TEST_HH
+#define EWOMS_LENS_LINEARIZATION_TEST_HH
+
+#include <opm/models/utils/start.hh>
+#include <opm/models/immiscible/immisciblemodel.hh>
+#include <opm/models/discretization/ecfv/ecfvdiscretization.hh>
+#include "problems/lensproblem.hh"
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+BEGIN_PROPERTIES
+
+NEW_TYPE_TAG(LensLinearizationTestProblem,
+             INHERITS_FROM(ImmiscibleTwoPhaseModel, LensBaseProblem));
+
+SET_TAG_PROP(LensLinearizationTestProblem, SpatialDiscretizationSplice, EcfvDiscretization);
+
+END_PROPERTIES
+
+/*!
+ * \brief Creates the simulator for a small lens problem.
+ *
+ * The saturations of the initial solution are randomized so that the partial
+ * derivatives of the residual are non-trivial. Since the random numbers are always
+ * the same, simulators which are created for different type tags exhibit the same
+ * solution.
+ *
+ * \param programName The name of the test program
+ * \param params The command line parameters besides the size of the grid
+ *
+ * \return The simulator or a null pointer if the parameters could not be set up
+ */
+template <class TypeTag>
+std::unique_ptr<typename GET_PROP_TYPE(TypeTag, Simulator)>
+createLensLinearizationTestSimulator(const char* programName,
+                                     std::vector<const char*> params = {})
+{
+    typedef typename GET_PROP_TYPE(TypeTag, Simulator) Simulator;
+    typedef typename GET_PROP_TYPE(TypeTag, ThreadManager) ThreadManager;
+    typedef typename GET_PROP_TYPE(TypeTag, Indices) Indices;
+
+    params.insert(params.begin(), { programName, "--cells-x=12", "--cells-y=8" });
+    if (Opm::setupParameters_<TypeTag>(static_cast<int>(params.size()), params.data()) != 0)
+        return nullptr;
+    ThreadManager::init();
+
+    std::unique_ptr<Simulator> simulator(new Simulator(/*verbose=*/false));
+    auto& model = simulator->model();
+    model.applyInitialSolution();
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> satDist(0.6, 0.9);
+    auto& solution = model.solution(/*timeIdx=*/0);
+    for (unsigned dofIdx = 0; dofIdx < solution.size(); ++dofIdx)
+        solution[dofIdx][Indices::saturation0Idx] = satDist(rng);
+    model.invalidateIntensiveQuantitiesCache(/*timeIdx=*/0);
+
+    return simulator;
+}
+
+/*!
+ * \brief Counts the values which deviate from their expected values by more than a
+ *        given tolerance and prints the first few of them.
+ */
+class LinearizationMismatchCounter
+{
+public:
+    explicit LinearizationMismatchCounter(const std::string& what)
+        : what_(what)
+        , numMismatches_(0)
+    {}
+
+    /*!
+     * \brief Compare a value to the expected one.
+     *
+     * \param location A description of the position of the value which is printed if it
+     *                 is wrong
+     */
+    void check(double actual, double expected, double tolerance, const std::string& location)
+    {
+        if (std::abs(actual - expected) <= tolerance)
+            return;
+
+        if (numMismatches_ < 10)
+            std::cout << location << " of " << what_ << " is " << actual
+                      << " instead of " << expected << "\n";
+        ++numMismatches_;
+    }
+
+    /*!
+     * \brief Print the total number of wrong values and return true if there were none.
+     */
+    bool report() const
+    {
+        if (numMismatches_ == 0)
+            return true;
+
+        std::cout << "Test failed: " << numMismatches_ << " values of " << what_
+                  << " are wrong\n";
+        return false;
+    }
+
+private:
+    std::string what_;
+    unsigned numMismatches_;
+};
+
+#endif // EWOMS_LENS_LINEARIZATION_TEST_HH
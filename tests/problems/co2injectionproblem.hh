@@ -305,6 +305,8 @@ public:
         solidEnergyLawParams_.setSolidHeatCapacity(790.0 // specific heat capacity of granite [J / (kg K)]
                                                    * 2700.0); // density of granite [kg/m^3]
         solidEnergyLawParams_.finalize();
+
+        this->updateStaticDataCache_();
     }
 
     /*!
@@ -403,6 +405,9 @@ public:
     const DimMatrix& intrinsicPermeability(const Context& context, unsigned spaceIdx,
                                            unsigned timeIdx) const
     {
+        if (const auto* staticData = this->cachedStaticDofData(context, spaceIdx, timeIdx))
+            return staticData->intrinsicPermeability;
+
         const GlobalPosition& pos = context.pos(spaceIdx, timeIdx);
         if (isFineMaterial_(pos))
             return fineK_;
@@ -415,6 +420,9 @@ public:
     template <class Context>
     Scalar porosity(const Context& context, unsigned spaceIdx, unsigned timeIdx) const
     {
+        if (const auto* staticData = this->cachedStaticDofData(context, spaceIdx, timeIdx))
+            return staticData->porosity;
+
         const GlobalPosition& pos = context.pos(spaceIdx, timeIdx);
         if (isFineMaterial_(pos))
             return finePorosity_;
@@ -428,6 +436,9 @@ public:
     const MaterialLawParams& materialLawParams(const Context& context,
                                                unsigned spaceIdx, unsigned timeIdx) const
     {
+        if (const auto* staticData = this->cachedStaticDofData(context, spaceIdx, timeIdx))
+            return *staticData->materialLawParams;
+
         const GlobalPosition& pos = context.pos(spaceIdx, timeIdx);
         if (isFineMaterial_(pos))
             return fineMaterialParams_;
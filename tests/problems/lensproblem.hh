@@ -276,6 +276,8 @@ public:
             this->gravity_ = 0;
             this->gravity_[1] = -9.81;
         }
+
+        this->updateStaticDataCache_();
     }
 
     /*!
@@ -349,6 +351,9 @@ public:
     const DimMatrix& intrinsicPermeability(const Context& context, unsigned spaceIdx,
                                            unsigned timeIdx) const
     {
+        if (const auto* staticData = this->cachedStaticDofData(context, spaceIdx, timeIdx))
+            return staticData->intrinsicPermeability;
+
         const GlobalPosition& globalPos = context.pos(spaceIdx, timeIdx);
 
         if (isInLens_(globalPos))
@@ -372,6 +377,9 @@ public:
     const MaterialLawParams& materialLawParams(const Context& context,
                                                unsigned spaceIdx, unsigned timeIdx) const
     {
+        if (const auto* staticData = this->cachedStaticDofData(context, spaceIdx, timeIdx))
+            return *staticData->materialLawParams;
+
         const GlobalPosition& globalPos = context.pos(spaceIdx, timeIdx);
 
         if (isInLens_(globalPos))
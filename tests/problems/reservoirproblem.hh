@@ -369,6 +369,8 @@ public:
             }
         }
 
+        this->updateStaticDataCache_();
+
         initFluidState_();
 
         // start the first ("settle down") episode for 100 days
@@ -440,6 +442,9 @@ public:
     const DimMatrix& intrinsicPermeability(const Context& context, unsigned spaceIdx,
                                            unsigned timeIdx) const
     {
+        if (const auto* staticData = this->cachedStaticDofData(context, spaceIdx, timeIdx))
+            return staticData->intrinsicPermeability;
+
         const GlobalPosition& pos = context.pos(spaceIdx, timeIdx);
         if (isFineMaterial_(pos))
             return fineK_;
@@ -452,6 +457,9 @@ public:
     template <class Context>
     Scalar porosity(const Context& context, unsigned spaceIdx, unsigned timeIdx) const
     {
+        if (const auto* staticData = this->cachedStaticDofData(context, spaceIdx, timeIdx))
+            return staticData->porosity;
+
         const GlobalPosition& pos = context.pos(spaceIdx, timeIdx);
         if (isFineMaterial_(pos))
             return finePorosity_;
@@ -465,6 +473,9 @@ public:
     const MaterialLawParams& materialLawParams(const Context& context,
                                                unsigned spaceIdx, unsigned timeIdx) const
     {
+        if (const auto* staticData = this->cachedStaticDofData(context, spaceIdx, timeIdx))
+            return *staticData->materialLawParams;
+
         unsigned globalIdx = context.globalSpaceIndex(spaceIdx, timeIdx);
         return *materialParams_[globalIdx];
     }
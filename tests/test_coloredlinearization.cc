@@ -0,0 +1,130 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Tests that the Jacobian matrix obtained using colored finite differences of
+ *        the global residual is the same as the one obtained by linearizing the
+ *        elements one by one.
+ */
+#include "config.h"
+
+#include "lenslinearizationtest.hh"
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+BEGIN_PROPERTIES
+
+NEW_TYPE_TAG(ColoredLinearizationTestProblem, INHERITS_FROM(LensLinearizationTestProblem));
+SET_TAG_PROP(ColoredLinearizationTestProblem, LocalLinearizerSplice, FiniteDifferenceLocalLinearizer);
+
+END_PROPERTIES
+
+int main(int argc, char **argv)
+{
+    typedef TTAG(ColoredLinearizationTestProblem) TypeTag;
+    typedef typename GET_PROP_TYPE(TypeTag, ElementContext) ElementContext;
+    typedef typename GET_PROP_TYPE(TypeTag, SparseMatrixAdapter) SparseMatrixAdapter;
+    typedef typename SparseMatrixAdapter::IstlMatrix IstlMatrix;
+
+    Dune::MPIHelper::instance(argc, argv);
+
+    auto simulator =
+        createLensLinearizationTestSimulator<TypeTag>(argv[0],
+                                                      { "--use-colored-finite-differences=true" });
+    if (!simulator)
+        return 1;
+    auto& model = simulator->model();
+
+    // linearize the system using colored finite differences
+    auto& linearizer = model.linearizer();
+    linearizer.linearize();
+    const IstlMatrix& coloredJacobian = linearizer.jacobian().istlMatrix();
+
+    // assemble the Jacobian element by element using the local linearizer in the same
+    // way as FvBaseLinearizer does if colored finite differences are not used
+    IstlMatrix jacobian(coloredJacobian);
+    jacobian = 0.0;
+    ElementContext elemCtx(*simulator);
+    auto& localLinearizer = model.localLinearizer(/*threadId=*/0);
+    auto elemIt = simulator->gridView().begin</*codim=*/0>();
+    const auto& elemEndIt = simulator->gridView().end</*codim=*/0>();
+    for (; elemIt != elemEndIt; ++elemIt) {
+        localLinearizer.linearize(elemCtx, *elemIt);
+
+        for (unsigned primaryDofIdx = 0;
+             primaryDofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0);
+             ++ primaryDofIdx)
+        {
+            unsigned globI = elemCtx.globalSpaceIndex(primaryDofIdx, /*timeIdx=*/0);
+            for (unsigned dofIdx = 0; dofIdx < elemCtx.numDof(/*timeIdx=*/0); ++ dofIdx) {
+                unsigned globJ = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+                jacobian[globJ][globI] += localLinearizer.jacobian(dofIdx, primaryDofIdx);
+            }
+        }
+    }
+
+    // compare the two matrices. the differences of the entries of a row are measured
+    // relative to the largest entry of the row because the rows of different equations
+    // exhibit different units.
+    const double tolerance = 1e-6;
+    LinearizationMismatchCounter mismatches("the colored Jacobian");
+    unsigned numRowsChecked = 0;
+    for (auto rowIt = jacobian.begin(); rowIt != jacobian.end(); ++rowIt) {
+        unsigned rowIdx = rowIt.index();
+        for (unsigned eqIdx = 0; eqIdx < IstlMatrix::block_type::rows; ++eqIdx) {
+            double rowScale = 0.0;
+            for (auto colIt = rowIt->begin(); colIt != rowIt->end(); ++colIt)
+                for (unsigned pvIdx = 0; pvIdx < IstlMatrix::block_type::cols; ++pvIdx)
+                    rowScale = std::max<double>(rowScale, std::abs((*colIt)[eqIdx][pvIdx]));
+
+            if (rowScale == 0.0)
+                continue;
+            ++numRowsChecked;
+
+            for (auto colIt = rowIt->begin(); colIt != rowIt->end(); ++colIt) {
+                unsigned colIdx = colIt.index();
+                for (unsigned pvIdx = 0; pvIdx < IstlMatrix::block_type::cols; ++pvIdx)
+                    mismatches.check(coloredJacobian[rowIdx][colIdx][eqIdx][pvIdx],
+                                     (*colIt)[eqIdx][pvIdx],
+                                     tolerance*rowScale,
+                                     "Entry (" + std::to_string(rowIdx) + ", "
+                                     + std::to_string(colIdx) + ")["
+                                     + std::to_string(eqIdx) + "]["
+                                     + std::to_string(pvIdx) + "]");
+            }
+        }
+    }
+
+    if (numRowsChecked == 0) {
+        std::cout << "Test failed: the Jacobian matrix is zero\n";
+        return 1;
+    }
+
+    return mismatches.report() ? 0 : 1;
+}
@@ -0,0 +1,203 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Tests the algorithms which compute the orderings of the degrees of freedom.
+ */
+#include "config.h"
+
+#include <opm/models/utils/dofreordering.hh>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+static bool check(bool condition, const char* what)
+{
+    if (!condition)
+        std::cout << "Test failed: " << what << "\n" << std::flush;
+    return condition;
+}
+
+static bool isPermutation(std::vector<unsigned> order)
+{
+    std::sort(order.begin(), order.end());
+    for (unsigned i = 0; i < order.size(); ++i)
+        if (order[i] != i)
+            return false;
+    return true;
+}
+
+// the connectivity graph of a structured 2D grid with numX x numY cells in compressed
+// row format. the cells are randomly numbered.
+struct Graph
+{
+    std::vector<size_t> rowOffsets;
+    std::vector<unsigned> neighbors;
+    std::vector<std::array<double, 2> > centers;
+};
+
+static Graph createGridGraph(unsigned numX, unsigned numY, std::mt19937& rng)
+{
+    unsigned numCells = numX*numY;
+    std::vector<unsigned> cellIdx(numCells);
+    for (unsigned i = 0; i < numCells; ++i)
+        cellIdx[i] = i;
+    std::shuffle(cellIdx.begin(), cellIdx.end(), rng);
+
+    std::vector<std::vector<unsigned> > adjacency(numCells);
+    Graph graph;
+    graph.centers.resize(numCells);
+    for (unsigned j = 0; j < numY; ++j) {
+        for (unsigned i = 0; i < numX; ++i) {
+            unsigned idx = cellIdx[j*numX + i];
+            graph.centers[idx] = {{ i + 0.5, j + 0.5 }};
+            if (i > 0)
+                adjacency[idx].push_back(cellIdx[j*numX + i - 1]);
+            if (i + 1 < numX)
+                adjacency[idx].push_back(cellIdx[j*numX + i + 1]);
+            if (j > 0)
+                adjacency[idx].push_back(cellIdx[(j - 1)*numX + i]);
+            if (j + 1 < numY)
+                adjacency[idx].push_back(cellIdx[(j + 1)*numX + i]);
+        }
+    }
+
+    graph.rowOffsets.push_back(0);
+    for (const auto& row : adjacency) {
+        graph.neighbors.insert(graph.neighbors.end(), row.begin(), row.end());
+        graph.rowOffsets.push_back(graph.neighbors.size());
+    }
+    return graph;
+}
+
+// the maximum difference of the indices of two connected vertices
+static unsigned bandwidth(const Graph& graph, const std::vector<unsigned>& order)
+{
+    std::vector<unsigned> newIdx(order.size());
+    for (unsigned i = 0; i < order.size(); ++i)
+        newIdx[order[i]] = i;
+
+    unsigned result = 0;
+    for (unsigned vertexIdx = 0; vertexIdx + 1 < graph.rowOffsets.size(); ++vertexIdx) {
+        for (size_t j = graph.rowOffsets[vertexIdx]; j < graph.rowOffsets[vertexIdx + 1]; ++j) {
+            unsigned a = newIdx[vertexIdx];
+            unsigned b = newIdx[graph.neighbors[j]];
+            result = std::max(result, (a > b) ? a - b : b - a);
+        }
+    }
+    return result;
+}
+
+static bool testReverseCuthillMcKee(std::mt19937& rng)
+{
+    bool success = true;
+
+    const unsigned numX = 100;
+    const unsigned numY = 20;
+    Graph graph = createGridGraph(numX, numY, rng);
+    std::vector<unsigned> order = Opm::reverseCuthillMcKeeOrder(graph.rowOffsets, graph.neighbors);
+
+    success = check(order.size() == numX*numY, "size of the RCM ordering") && success;
+    success = check(isPermutation(order), "RCM ordering is a permutation") && success;
+
+    // a level structure of the grid has at most numY + 1 vertices per level, so the
+    // bandwidth of the RCM ordering is in the order of the smaller grid dimension
+    success = check(bandwidth(graph, order) <= 2*numY, "bandwidth of the RCM ordering") && success;
+
+    // the ordering only depends on the graph
+    success = check(order == Opm::reverseCuthillMcKeeOrder(graph.rowOffsets, graph.neighbors),
+                    "RCM ordering is deterministic") && success;
+
+    // a graph with several connected components and isolated vertices
+    std::vector<size_t> rowOffsets = { 0, 1, 2, 2, 4, 5, 6, 6 };
+    std::vector<unsigned> neighbors = { 1, 0, 4, 5, 3, 3 };
+    order = Opm::reverseCuthillMcKeeOrder(rowOffsets, neighbors);
+    success = check(order.size() == 7 && isPermutation(order),
+                    "RCM ordering of disconnected graphs") && success;
+
+    return success;
+}
+
+static bool testHilbertCurve(std::mt19937& rng)
+{
+    bool success = true;
+
+    const unsigned numX = 64;
+    const unsigned numY = 64;
+    Graph graph = createGridGraph(numX, numY, rng);
+    std::vector<unsigned> order = Opm::hilbertCurveOrder<unsigned, 2>(graph.centers);
+
+    success = check(order.size() == numX*numY, "size of the Hilbert ordering") && success;
+    success = check(isPermutation(order), "Hilbert ordering is a permutation") && success;
+
+    // for a grid of 2^n x 2^n cells, consecutive cells on the Hilbert curve are
+    // always neighbors
+    bool isContinuous = true;
+    for (unsigned i = 0; i + 1 < order.size(); ++i) {
+        const auto& a = graph.centers[order[i]];
+        const auto& b = graph.centers[order[i + 1]];
+        if (std::abs(a[0] - b[0]) + std::abs(a[1] - b[1]) != 1.0)
+            isContinuous = false;
+    }
+    success = check(isContinuous, "continuity of the Hilbert curve") && success;
+
+    // the 3D variant
+    std::vector<std::array<double, 3> > points;
+    for (unsigned k = 0; k < 8; ++k)
+        for (unsigned j = 0; j < 8; ++j)
+            for (unsigned i = 0; i < 8; ++i)
+                points.push_back({{ double(i), double(j), double(k) }});
+    std::shuffle(points.begin(), points.end(), rng);
+    std::vector<unsigned> order3d = Opm::hilbertCurveOrder<unsigned, 3>(points);
+    success = check(isPermutation(order3d), "3D Hilbert ordering is a permutation") && success;
+
+    isContinuous = true;
+    for (unsigned i = 0; i + 1 < order3d.size(); ++i) {
+        const auto& a = points[order3d[i]];
+        const auto& b = points[order3d[i + 1]];
+        if (std::abs(a[0] - b[0]) + std::abs(a[1] - b[1]) + std::abs(a[2] - b[2]) != 1.0)
+            isContinuous = false;
+    }
+    success = check(isContinuous, "continuity of the 3D Hilbert curve") && success;
+
+    return success;
+}
+
+int main()
+{
+    std::mt19937 rng(42);
+
+    bool success = true;
+    success = testReverseCuthillMcKee(rng) && success;
+    success = testHilbertCurve(rng) && success;
+    success = check(Opm::dofOrderingFromString("rcm") == Opm::rcmDofOrdering,
+                    "parsing the ordering") && success;
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Tests the arithmetic kernels of Opm::MatrixBlock against the generic ones of
+ *        Dune::FieldMatrix and measures their performance for all block sizes which
+ *        are relevant in practice.
+ */
+#include "config.h"
+
+#include <opm/simulators/linalg/matrixblock.hh>
+
+#include <dune/common/fvector.hh>
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+static const int numBlocks = 20000;
+static const int numRepetitions = 100;
+
+template <int n>
+bool checkAndBenchmark(std::mt19937& rng)
+{
+    typedef Opm::MatrixBlock<double, n, n> Block;
+    typedef Dune::FieldMatrix<double, n, n> BaseBlock;
+    typedef Dune::FieldVector<double, n> Vector;
+    typedef Opm::MatrixBlockHelp::BlockKernels<double, n, n> Kernels;
+
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+
+    std::vector<Block> blocks(numBlocks);
+    std::vector<Vector> x(numBlocks);
+    for (int blockIdx = 0; blockIdx < numBlocks; ++blockIdx) {
+        for (int i = 0; i < n; ++i) {
+            x[blockIdx][i] = dist(rng);
+            for (int j = 0; j < n; ++j)
+                blocks[blockIdx][i][j] = dist(rng);
+        }
+    }
+
+    // compare the results of the specialized kernels with the generic ones
+    bool success = true;
+    const double tol = 1e-13;
+    for (int blockIdx = 0; blockIdx + 1 < numBlocks; ++blockIdx) {
+        const Block& A = blocks[blockIdx];
+        const Block& B = blocks[blockIdx + 1];
+        const BaseBlock& baseA = A.asBase();
+        const BaseBlock& baseB = B.asBase();
+
+        Vector y1(0.5), y2(0.5);
+        A.umv(x[blockIdx], y1);
+        baseA.umv(x[blockIdx], y2);
+        y1 -= y2;
+        success = success && y1.infinity_norm() < tol;
+
+        y1 = 0.5;
+        y2 = 0.5;
+        A.mmv(x[blockIdx], y1);
+        baseA.mmv(x[blockIdx], y2);
+        y1 -= y2;
+        success = success && y1.infinity_norm() < tol;
+
+        Block C1(A);
+        BaseBlock C2(baseA);
+        C1.rightmultiply(B);
+        C2.rightmultiply(baseB);
+        C1.asBase() -= C2;
+        success = success && C1.infinity_norm() < tol;
+
+        C1 = A;
+        C2 = baseA;
+        C1.leftmultiply(B);
+        C2.leftmultiply(baseB);
+        C1.asBase() -= C2;
+        success = success && C1.infinity_norm() < tol;
+    }
+
+    // measure the time required by the y -= A*x operation which dominates the
+    // sparse matrix-vector products and the ILU back solves
+    typedef std::chrono::high_resolution_clock Clock;
+    Vector y(0.0);
+    auto startTime = Clock::now();
+    for (int repIdx = 0; repIdx < numRepetitions; ++repIdx)
+        for (int blockIdx = 0; blockIdx < numBlocks; ++blockIdx)
+            blocks[blockIdx].mmv(x[blockIdx], y);
+    double specializedTime = std::chrono::duration<double>(Clock::now() - startTime).count();
+
+    Vector yBase(0.0);
+    startTime = Clock::now();
+    for (int repIdx = 0; repIdx < numRepetitions; ++repIdx)
+        for (int blockIdx = 0; blockIdx < numBlocks; ++blockIdx)
+            blocks[blockIdx].asBase().mmv(x[blockIdx], yBase);
+    double genericTime = std::chrono::duration<double>(Clock::now() - startTime).count();
+
+    // the same for the A = A*B operation used by the ILU decomposition
+    startTime = Clock::now();
+    for (int repIdx = 0; repIdx < numRepetitions; ++repIdx)
+        for (int blockIdx = 0; blockIdx + 1 < numBlocks; ++blockIdx) {
+            Block C(blocks[blockIdx]);
+            C.rightmultiply(blocks[blockIdx + 1]);
+            y[0] += C[0][0];
+        }
+    double specializedMulTime = std::chrono::duration<double>(Clock::now() - startTime).count();
+
+    startTime = Clock::now();
+    for (int repIdx = 0; repIdx < numRepetitions; ++repIdx)
+        for (int blockIdx = 0; blockIdx + 1 < numBlocks; ++blockIdx) {
+            BaseBlock C(blocks[blockIdx].asBase());
+            C.rightmultiply(blocks[blockIdx + 1].asBase());
+            yBase[0] += C[0][0];
+        }
+    double genericMulTime = std::chrono::duration<double>(Clock::now() - startTime).count();
+
+    double numOps = static_cast<double>(numBlocks)*numRepetitions;
+    std::cout << n << "x" << n << " blocks"
+              << (Kernels::isVectorized ? " (vectorized)" : "")
+              << ": mmv " << std::setprecision(3)
+              << genericTime/numOps*1e9 << " ns -> " << specializedTime/numOps*1e9 << " ns"
+              << ", rightmultiply "
+              << genericMulTime/numOps*1e9 << " ns -> " << specializedMulTime/numOps*1e9 << " ns"
+              << (success ? "" : ", RESULTS DIFFER")
+              << "\n" << std::flush;
+
+    // make sure that the compiler does not optimize the benchmark loops away
+    if (!std::isfinite(y[0] + yBase[0]))
+        std::cout << "non-finite result\n";
+
+    return success;
+}
+
+int main()
+{
+    std::mt19937 rng(42);
+
+    bool success = true;
+    success = checkAndBenchmark<1>(rng) && success;
+    success = checkAndBenchmark<2>(rng) && success;
+    success = checkAndBenchmark<3>(rng) && success;
+    success = checkAndBenchmark<4>(rng) && success;
+    success = checkAndBenchmark<5>(rng) && success;
+    success = checkAndBenchmark<6>(rng) && success;
+
+    return success ? 0 : 1;
+}
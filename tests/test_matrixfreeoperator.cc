@@ -0,0 +1,163 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Tests that a matrix-free linearization only assembles the diagonal blocks of
+ *        the Jacobian matrix and that Opm::Linear::MatrixFreeOverlappingOperator yields
+ *        the same result as multiplying a vector with the fully assembled Jacobian.
+ */
+#include "config.h"
+
+#include "lenslinearizationtest.hh"
+
+#include <opm/simulators/linalg/matrixfreeoperator.hh>
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+
+BEGIN_PROPERTIES
+
+// the reference assembles the full Jacobian matrix
+NEW_TYPE_TAG(MatrixFreeReferenceProblem, INHERITS_FROM(LensLinearizationTestProblem));
+SET_TAG_PROP(MatrixFreeReferenceProblem, LocalLinearizerSplice, AutoDiffLocalLinearizer);
+
+NEW_TYPE_TAG(MatrixFreeOperatorTestProblem, INHERITS_FROM(MatrixFreeReferenceProblem));
+SET_BOOL_PROP(MatrixFreeOperatorTestProblem, EnableMatrixFreeLinearization, true);
+SET_TYPE_PROP(MatrixFreeOperatorTestProblem, OverlappingLinearOperator,
+              Opm::Linear::MatrixFreeOverlappingOperator<TypeTag>);
+
+END_PROPERTIES
+
+int main(int argc, char **argv)
+{
+    typedef TTAG(MatrixFreeReferenceProblem) ReferenceTypeTag;
+    typedef TTAG(MatrixFreeOperatorTestProblem) TypeTag;
+    typedef typename GET_PROP_TYPE(TypeTag, GlobalEqVector) GlobalEqVector;
+    typedef typename GET_PROP_TYPE(TypeTag, Indices) Indices;
+    typedef typename GET_PROP_TYPE(TypeTag, BorderListCreator) BorderListCreator;
+    typedef typename GET_PROP_TYPE(TypeTag, OverlappingMatrix) OverlappingMatrix;
+    typedef typename GET_PROP_TYPE(TypeTag, OverlappingVector) OverlappingVector;
+    typedef typename GET_PROP_TYPE(TypeTag, OverlappingLinearOperator) MatrixFreeOperator;
+
+    Dune::MPIHelper::instance(argc, argv);
+
+    auto referenceSimulator = createLensLinearizationTestSimulator<ReferenceTypeTag>(argv[0]);
+    auto simulator = createLensLinearizationTestSimulator<TypeTag>(argv[0]);
+    if (!referenceSimulator || !simulator)
+        return 1;
+
+    auto& referenceLinearizer = referenceSimulator->model().linearizer();
+    referenceLinearizer.linearize();
+    const auto& referenceJacobian = referenceLinearizer.jacobian().istlMatrix();
+
+    auto& linearizer = simulator->model().linearizer();
+    linearizer.linearize();
+    const auto& jacobian = linearizer.jacobian().istlMatrix();
+
+    // the matrix-free linearization only stores the diagonal blocks of the Jacobian
+    bool success = true;
+    if (jacobian.nonzeroes() != jacobian.N()) {
+        std::cout << "Test failed: the matrix-free linearization assembled "
+                  << jacobian.nonzeroes() << " blocks instead of " << jacobian.N() << "\n";
+        success = false;
+    }
+
+    LinearizationMismatchCounter diagonalMismatches("the diagonal of the matrix-free Jacobian");
+    for (unsigned rowIdx = 0; rowIdx < jacobian.N(); ++rowIdx) {
+        const auto& block = jacobian[rowIdx][rowIdx];
+        const auto& referenceBlock = referenceJacobian[rowIdx][rowIdx];
+        for (unsigned eqIdx = 0; eqIdx < block.rows; ++eqIdx)
+            for (unsigned pvIdx = 0; pvIdx < block.cols; ++pvIdx)
+                diagonalMismatches.check(block[eqIdx][pvIdx],
+                                         referenceBlock[eqIdx][pvIdx],
+                                         1e-12*std::abs(referenceBlock[eqIdx][pvIdx]),
+                                         "Entry (" + std::to_string(rowIdx) + ")["
+                                         + std::to_string(eqIdx) + "]["
+                                         + std::to_string(pvIdx) + "]");
+    }
+    success = diagonalMismatches.report() && success;
+
+    BorderListCreator borderListCreator(simulator->gridView(), simulator->model().dofMapper());
+    OverlappingMatrix overlappingMatrix(jacobian,
+                                        borderListCreator.borderList(),
+                                        borderListCreator.blackList(),
+                                        /*overlapSize=*/2);
+    overlappingMatrix.assignFromNative(jacobian);
+    overlappingMatrix.syncAdd();
+    MatrixFreeOperator matrixFreeOperator(overlappingMatrix, *simulator);
+
+    // both products are computed from the same local Jacobian matrices, so they may only
+    // differ by the rounding errors caused by the order of the summation. the pressures
+    // and the saturations of the directions exhibit very different magnitudes.
+    LinearizationMismatchCounter productMismatches("the matrix-free product");
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (unsigned testIdx = 0; testIdx < 3; ++testIdx) {
+        GlobalEqVector x(jacobian.N());
+        for (unsigned dofIdx = 0; dofIdx < x.size(); ++dofIdx) {
+            x[dofIdx][Indices::pressure0Idx] = 1e5*dist(rng);
+            x[dofIdx][Indices::saturation0Idx] = 1e-1*dist(rng);
+        }
+
+        GlobalEqVector expected(x.size());
+        GlobalEqVector scale(x.size());
+        expected = 0.0;
+        scale = 0.0;
+        for (auto rowIt = referenceJacobian.begin(); rowIt != referenceJacobian.end(); ++rowIt) {
+            unsigned rowIdx = rowIt.index();
+            for (auto colIt = rowIt->begin(); colIt != rowIt->end(); ++colIt) {
+                const auto& block = *colIt;
+                const auto& xBlock = x[colIt.index()];
+                for (unsigned i = 0; i < block.rows; ++i) {
+                    for (unsigned j = 0; j < block.cols; ++j) {
+                        expected[rowIdx][i] += block[i][j]*xBlock[j];
+                        scale[rowIdx][i] += std::abs(block[i][j]*xBlock[j]);
+                    }
+                }
+            }
+        }
+
+        OverlappingVector overlappingX(overlappingMatrix.overlap());
+        OverlappingVector overlappingY(overlappingX);
+        overlappingX.assignAddBorder(x);
+        matrixFreeOperator.apply(overlappingX, overlappingY);
+        GlobalEqVector actual(x.size());
+        overlappingY.assignTo(actual);
+
+        for (unsigned rowIdx = 0; rowIdx < x.size(); ++rowIdx)
+            for (unsigned eqIdx = 0; eqIdx < x[rowIdx].size(); ++eqIdx)
+                productMismatches.check(actual[rowIdx][eqIdx],
+                                        expected[rowIdx][eqIdx],
+                                        1e-10*scale[rowIdx][eqIdx],
+                                        "Component " + std::to_string(eqIdx) + " of row "
+                                        + std::to_string(rowIdx));
+    }
+    success = productMismatches.report() && success;
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,268 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Tests that the results of Opm::ReproducibleSum are bit-wise identical
+ *        regardless of the order of the summands, the number of threads and the
+ *        number of processes.
+ */
+#include "config.h"
+
+#include <opm/models/parallel/reproduciblesum.hh>
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+static bool bitwiseEqual(double a, double b)
+{ return std::memcmp(&a, &b, sizeof(double)) == 0; }
+
+static bool check(bool condition, const char* what)
+{
+    if (!condition)
+        std::cout << "Test failed: " << what << "\n" << std::flush;
+    return condition;
+}
+
+// summands with a large dynamic range and lots of cancellation
+static std::vector<double> createSummands(std::mt19937& rng, size_t n)
+{
+    std::uniform_real_distribution<double> mantissaDist(-1.0, 1.0);
+    std::uniform_int_distribution<int> exponentDist(-40, 40);
+
+    std::vector<double> summands(n);
+    for (size_t i = 0; i < n; ++i)
+        summands[i] = std::ldexp(mantissaDist(rng), exponentDist(rng));
+    return summands;
+}
+
+static double reproducibleSum(const std::vector<double>& summands,
+                              size_t begin = 0,
+                              size_t stride = 1)
+{
+    Opm::ReproducibleSum sum;
+    for (size_t i = begin; i < summands.size(); i += stride)
+        sum += summands[i];
+    return sum.value();
+}
+
+static bool testExactness()
+{
+    bool success = true;
+
+    Opm::ReproducibleSum sum;
+    sum += 1e100;
+    sum += 1.0;
+    sum += -1e100;
+    success = check(sum.value() == 1.0, "catastrophic cancellation") && success;
+
+    sum.clear();
+    sum += std::numeric_limits<double>::denorm_min();
+    sum += std::numeric_limits<double>::max();
+    sum += -std::numeric_limits<double>::max();
+    success = check(sum.value() == std::numeric_limits<double>::denorm_min(),
+                    "extreme exponents") && success;
+
+    sum.clear();
+    for (int i = 0; i < 10; ++i)
+        sum += 0.1;
+    success = check(std::abs(sum.value() - 1.0) <= std::numeric_limits<double>::epsilon(),
+                    "rounding of the result") && success;
+
+    sum.clear();
+    sum += -3.0;
+    sum += 0.5;
+    success = check(sum.value() == -2.5, "negative results") && success;
+
+    sum += std::numeric_limits<double>::infinity();
+    success = check(sum.value() == std::numeric_limits<double>::infinity(),
+                    "infinite summands") && success;
+    sum += -std::numeric_limits<double>::infinity();
+    success = check(std::isnan(sum.value()), "infinite summands of both signs") && success;
+
+    return success;
+}
+
+static bool testRounding(std::mt19937& rng)
+{
+    bool success = true;
+
+    const double eps = std::numeric_limits<double>::epsilon();
+    std::vector<double> summands;
+
+    // ties are rounded to even
+    summands = { 1.0, eps/2 };
+    success = check(bitwiseEqual(reproducibleSum(summands), 1.0), "rounding of ties") && success;
+    summands = { 1.0 + eps, eps/2 };
+    success = check(bitwiseEqual(reproducibleSum(summands), 1.0 + 2*eps),
+                    "rounding of ties") && success;
+
+    // bits far below the last bit of the result break ties
+    summands = { 1.0, eps/2, std::ldexp(1.0, -200) };
+    success = check(bitwiseEqual(reproducibleSum(summands), 1.0 + eps),
+                    "rounding using a sticky bit") && success;
+    summands = { 1.0, eps/2, -std::ldexp(1.0, -200) };
+    success = check(bitwiseEqual(reproducibleSum(summands), 1.0),
+                    "rounding using a sticky bit") && success;
+
+    // the floating point sum of two numbers is rounded correctly, so it must be
+    // matched exactly. this includes subnormal results.
+    std::uniform_real_distribution<double> mantissaDist(-1.0, 1.0);
+    std::uniform_int_distribution<int> exponentDist(-1070, 1020);
+    std::uniform_int_distribution<int> exponentDiffDist(-60, 60);
+    bool allEqual = true;
+    for (int i = 0; i < 100000; ++i) {
+        int exponent = exponentDist(rng);
+        double a = std::ldexp(mantissaDist(rng), exponent);
+        double b = std::ldexp(mantissaDist(rng), exponent + exponentDiffDist(rng));
+        summands = { a, b };
+        allEqual = allEqual && bitwiseEqual(reproducibleSum(summands), a + b);
+    }
+    success = check(allEqual, "correct rounding of the sum of two numbers") && success;
+
+    return success;
+}
+
+static bool testOrderIndependence(std::mt19937& rng)
+{
+    bool success = true;
+
+    std::vector<double> summands = createSummands(rng, 100000);
+    double reference = reproducibleSum(summands);
+
+    // the exact sum of the summands and their negatives is zero
+    std::vector<double> zeroSum(summands);
+    for (double x : summands)
+        zeroSum.push_back(-x);
+    std::shuffle(zeroSum.begin(), zeroSum.end(), rng);
+    success = check(reproducibleSum(zeroSum) == 0.0, "exact cancellation") && success;
+
+    // permutations of the summands
+    for (int permIdx = 0; permIdx < 5; ++permIdx) {
+        std::shuffle(summands.begin(), summands.end(), rng);
+        success = check(bitwiseEqual(reproducibleSum(summands), reference),
+                        "permutation of the summands") && success;
+    }
+
+    // partial sums which are merged in different orders, i.e., the way a reduction
+    // over threads or processes works
+    for (unsigned numParts : {2u, 3u, 4u, 7u, 16u}) {
+        std::vector<Opm::ReproducibleSum> partialSums(numParts);
+        for (size_t i = 0; i < summands.size(); ++i)
+            partialSums[i%numParts] += summands[i];
+
+        Opm::ReproducibleSum forward;
+        for (unsigned partIdx = 0; partIdx < numParts; ++partIdx)
+            forward.merge(partialSums[partIdx]);
+
+        Opm::ReproducibleSum backward;
+        for (unsigned partIdx = numParts; partIdx > 0; --partIdx)
+            backward.merge(partialSums[partIdx - 1]);
+
+        success = check(bitwiseEqual(forward.value(), reference), "merging partial sums") && success;
+        success = check(bitwiseEqual(backward.value(), reference), "merging partial sums") && success;
+    }
+
+    return success;
+}
+
+static bool testThreads(std::mt19937& rng)
+{
+    bool success = true;
+
+#ifdef _OPENMP
+    std::vector<double> summands = createSummands(rng, 1000000);
+    double reference = reproducibleSum(summands);
+
+    for (int numThreads : {1, 2, 4}) {
+        Opm::ReproducibleSum sum;
+        long n = static_cast<long>(summands.size());
+
+#pragma omp parallel num_threads(numThreads)
+        {
+            Opm::ReproducibleSum threadSum;
+#pragma omp for schedule(dynamic, 1000)
+            for (long i = 0; i < n; ++i)
+                threadSum += summands[i];
+
+#pragma omp critical
+            sum.merge(threadSum);
+        }
+
+        success = check(bitwiseEqual(sum.value(), reference), "summation using threads") && success;
+    }
+#else
+    // avoid a warning about an unused parameter
+    (void) rng;
+#endif
+
+    return success;
+}
+
+static bool testProcesses(std::mt19937& rng)
+{
+    const auto& comm = Dune::MPIHelper::getCollectiveCommunication();
+
+    // all processes use the same summands, but each one only adds a part of them
+    std::vector<double> summands = createSummands(rng, 100000);
+    double reference = reproducibleSum(summands);
+
+    Opm::ReproducibleSum sums[2];
+    for (size_t i = comm.rank(); i < summands.size(); i += comm.size()) {
+        sums[0] += summands[i];
+        sums[1] += -2.0*summands[i];
+    }
+    Opm::ReproducibleSum::sumOverProcesses(sums, 2, comm);
+
+    bool success = true;
+    success = check(bitwiseEqual(sums[0].value(), reference), "summation over processes") && success;
+    success = check(bitwiseEqual(sums[1].value(), -2.0*reference), "summation over processes") && success;
+    return success;
+}
+
+int main(int argc, char** argv)
+{
+    const auto& mpiHelper = Dune::MPIHelper::instance(argc, argv);
+    std::mt19937 rng(42);
+
+    bool success = true;
+    success = testExactness() && success;
+    success = testRounding(rng) && success;
+    success = testOrderIndependence(rng) && success;
+    success = testThreads(rng) && success;
+    success = testProcesses(rng) && success;
+
+    int allSucceeded = mpiHelper.getCollectiveCommunication().min(success ? 1 : 0);
+    return allSucceeded ? 0 : 1;
+}
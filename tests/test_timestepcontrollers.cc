@@ -0,0 +1,294 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Tests the time step sizes suggested by the time step controllers for
+ *        synthetic reports of time integrations.
+ */
+#include "config.h"
+
+#include <opm/models/nonlinear/timestepcontrollers.hh>
+
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// the parts of the simulator which are accessed by the time step controllers. the
+// solutions of a single degree of freedom with a single primary variable are set by
+// the tests.
+class MockSimulator
+{
+public:
+    typedef std::array<double, 1> PrimaryVariables;
+
+    struct Problem
+    {
+        double minTimeStepSize() const
+        { return 1e-3; }
+    };
+
+    struct NewtonMethod
+    {
+        double suggestTimeStepSize(double dt) const
+        { return 2*dt; }
+    };
+
+    class Model
+    {
+    public:
+        Model()
+            : solution_{{ std::vector<PrimaryVariables>(1), std::vector<PrimaryVariables>(1) }}
+        {}
+
+        const NewtonMethod& newtonMethod() const
+        { return newtonMethod_; }
+
+        const std::vector<PrimaryVariables>& solution(unsigned timeIdx) const
+        { return solution_[timeIdx]; }
+
+        size_t numGridDof() const
+        { return 1; }
+
+        bool isLocalDof(unsigned dofIdx OPM_UNUSED) const
+        { return true; }
+
+        double primaryVarWeight(unsigned dofIdx OPM_UNUSED, unsigned pvIdx OPM_UNUSED) const
+        { return 1.0; }
+
+        bool primaryVarsExtrapolable(const PrimaryVariables& uNew OPM_UNUSED,
+                                     const PrimaryVariables& uOld OPM_UNUSED) const
+        { return true; }
+
+        // the primary variable changes from uOld to uNew over a time step
+        void setSolutions(double uOld, double uNew)
+        {
+            solution_[1][0][0] = uOld;
+            solution_[0][0][0] = uNew;
+        }
+
+    private:
+        NewtonMethod newtonMethod_;
+        std::array<std::vector<PrimaryVariables>, 2> solution_;
+    };
+
+    struct GridView
+    {
+        struct Communication
+        {
+            template <class T>
+            T max(const T& value) const
+            { return value; }
+        };
+
+        Communication comm() const
+        { return Communication(); }
+    };
+
+    const Problem& problem() const
+    { return problem_; }
+
+    const Model& model() const
+    { return model_; }
+
+    Model& model()
+    { return model_; }
+
+    GridView gridView() const
+    { return GridView(); }
+
+private:
+    Problem problem_;
+    Model model_;
+};
+
+BEGIN_PROPERTIES
+
+NEW_TYPE_TAG(TimeStepControllerTestBase, INHERITS_FROM(ParameterSystem));
+
+SET_TYPE_PROP(TimeStepControllerTestBase, Scalar, double);
+SET_TYPE_PROP(TimeStepControllerTestBase, Simulator, MockSimulator);
+SET_INT_PROP(TimeStepControllerTestBase, NumEq, 1);
+SET_SCALAR_PROP(TimeStepControllerTestBase, TimeStepControlTolerance, 0.1);
+SET_SCALAR_PROP(TimeStepControllerTestBase, TimeStepControlMaxGrowth, 3.0);
+
+// the controllers register their parameters with different descriptions, so each of
+// them needs its own parameter storage
+NEW_TYPE_TAG(PidTimeStepControllerTest, INHERITS_FROM(TimeStepControllerTestBase));
+NEW_TYPE_TAG(ErrorEstimateTimeStepControllerTest, INHERITS_FROM(TimeStepControllerTestBase));
+
+END_PROPERTIES
+
+typedef Opm::PidTimeStepController<TTAG(PidTimeStepControllerTest)> PidController;
+typedef Opm::ErrorEstimateTimeStepController<TTAG(ErrorEstimateTimeStepControllerTest)> ErrorEstimateController;
+
+static_assert(PidController::needsRelativeChange,
+              "The PID controller is based on the relative change of the primary variables");
+static_assert(!ErrorEstimateController::needsRelativeChange,
+              "The error estimate is computed from the solutions");
+
+static bool checkDt(double actual, double expected, const std::string& what)
+{
+    if (std::abs(actual - expected) <= 1e-12*std::abs(expected))
+        return true;
+
+    std::cout << "Test failed: " << what << ": suggested time step size is " << actual
+              << " instead of " << expected << "\n" << std::flush;
+    return false;
+}
+
+static Opm::TimeStepReport<double> createReport(double dt,
+                                                double maxRelativeChange,
+                                                unsigned numFailures = 0)
+{
+    Opm::TimeStepReport<double> report;
+    report.timeStepSize = dt;
+    report.numNewtonIterations = 3;
+    report.numLinearIterations = 10;
+    report.numFailures = numFailures;
+    report.maxRelativeChange = maxRelativeChange;
+    report.wallTime = 1.0;
+    return report;
+}
+
+static bool testPidController(MockSimulator& simulator)
+{
+    bool success = true;
+
+    // the errors of the previous time steps are initialized to the tolerance, so the
+    // proportional and integral terms see an error which was halved
+    {
+        PidController controller(simulator);
+        controller.timeStepDone(createReport(10.0, 0.05));
+        success = checkDt(controller.suggestTimeStepSize(10.0),
+                          10.0*std::pow(2.0, 0.075 + 0.175 + 0.01),
+                          "PID controller below the tolerance") && success;
+    }
+
+    // the time step size is reduced proportionally if the change is too large
+    {
+        PidController controller(simulator);
+        controller.timeStepDone(createReport(10.0, 0.4));
+        success = checkDt(controller.suggestTimeStepSize(10.0), 2.5,
+                          "PID controller above the tolerance") && success;
+    }
+
+    // the growth of the time step size is limited
+    {
+        PidController controller(simulator);
+        controller.timeStepDone(createReport(10.0, 0.0));
+        success = checkDt(controller.suggestTimeStepSize(10.0), 30.0,
+                          "PID controller without any change") && success;
+    }
+
+    // the time step size is not increased directly after a failure
+    {
+        PidController controller(simulator);
+        controller.timeStepDone(createReport(10.0, 0.05, /*numFailures=*/1));
+        success = checkDt(controller.suggestTimeStepSize(10.0), 10.0,
+                          "PID controller after a failure") && success;
+    }
+
+    // the time step size is not reduced below the minimum
+    {
+        PidController controller(simulator);
+        controller.timeStepDone(createReport(1.0, 1e3));
+        success = checkDt(controller.suggestTimeStepSize(1.0), 1e-3,
+                          "PID controller below the minimum time step size") && success;
+    }
+
+    return success;
+}
+
+static bool testErrorEstimateController(MockSimulator& simulator)
+{
+    bool success = true;
+    auto& model = simulator.model();
+
+    // the error is estimated by extrapolating the change of the previous time step. the
+    // second time step is twice as long as the first one.
+    auto runTwoTimeSteps = [&model](ErrorEstimateController& controller, double secondDelta)
+    {
+        model.setSolutions(0.0, 1.0);
+        controller.timeStepDone(createReport(1.0, 0.0));
+        model.setSolutions(1.0, 1.0 + secondDelta);
+        controller.timeStepDone(createReport(2.0, 0.0));
+    };
+
+    // without a previous time step, the controller falls back to the Newton method
+    {
+        ErrorEstimateController controller(simulator);
+        model.setSolutions(0.0, 1.0);
+        controller.timeStepDone(createReport(1.0, 0.0));
+        success = checkDt(controller.suggestTimeStepSize(1.0), 2.0,
+                          "error estimate without history") && success;
+    }
+
+    // a linear evolution of the solution does not exhibit an error, so the growth is
+    // only limited by the maximum growth factor
+    {
+        ErrorEstimateController controller(simulator);
+        runTwoTimeSteps(controller, 2.0);
+        success = checkDt(controller.suggestTimeStepSize(2.0), 6.0,
+                          "error estimate for a linear solution") && success;
+    }
+
+    // the error is |2.6 - 2*1|*2/(2 + 1) = 0.4, i.e., four times the tolerance
+    {
+        ErrorEstimateController controller(simulator);
+        runTwoTimeSteps(controller, 2.6);
+        success = checkDt(controller.suggestTimeStepSize(2.0), 2.0*0.9*std::sqrt(0.1/0.4),
+                          "error estimate above the tolerance") && success;
+    }
+
+    // the time step size is reduced by at most a factor of five
+    {
+        ErrorEstimateController controller(simulator);
+        runTwoTimeSteps(controller, 20.0);
+        success = checkDt(controller.suggestTimeStepSize(2.0), 0.4,
+                          "error estimate for a large error") && success;
+    }
+
+    return success;
+}
+
+int main()
+{
+    typedef TTAG(PidTimeStepControllerTest) PidTypeTag;
+    typedef TTAG(ErrorEstimateTimeStepControllerTest) ErrorEstimateTypeTag;
+
+    PidController::registerParameters();
+    EWOMS_END_PARAM_REGISTRATION(PidTypeTag);
+    ErrorEstimateController::registerParameters();
+    EWOMS_END_PARAM_REGISTRATION(ErrorEstimateTypeTag);
+
+    MockSimulator simulator;
+
+    bool success = true;
+    success = testPidController(simulator) && success;
+    success = testErrorEstimateController(simulator) && success;
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,245 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Writes a VTU file using Opm::VtkAppendedRawWriter and reads it back to check
+ *        the offsets in the headers of the data arrays, the sizes of the binary blocks
+ *        and the written values.
+ */
+#include "config.h"
+
+#include <opm/models/io/vtkappendedrawwriter.hh>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/grid/yaspgrid.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+static bool check(bool condition, const std::string& what)
+{
+    if (!condition)
+        std::cout << "Test failed: " << what << "\n" << std::flush;
+    return condition;
+}
+
+// the value of an XML attribute which follows a given position of the file
+static std::string attribute(const std::string& file, const std::string& name, size_t& pos)
+{
+    std::string key = " " + name + "=\"";
+    pos = file.find(key, pos);
+    if (pos == std::string::npos)
+        return "";
+    pos += key.size();
+    size_t endPos = file.find('"', pos);
+    return file.substr(pos, endPos - pos);
+}
+
+// the header of a data array and the contents of its binary block
+struct DataArray
+{
+    std::string type;
+    unsigned numComponents;
+    uint64_t offset;
+    std::vector<char> data;
+
+    template <class T>
+    T value(size_t idx) const
+    {
+        T result;
+        std::memcpy(&result, data.data() + idx*sizeof(T), sizeof(T));
+        return result;
+    }
+};
+
+// reads the headers of all data arrays of a VTU file and checks that the size of each
+// binary block matches the distance of its offset to the one of the next block
+static bool readDataArrays(const std::string& file, std::vector<DataArray>& arrays)
+{
+    bool success = true;
+
+    size_t pos = 0;
+    while ((pos = file.find("<DataArray", pos)) != std::string::npos) {
+        DataArray array;
+        array.type = attribute(file, "type", pos);
+        array.numComponents = static_cast<unsigned>(std::stoul(attribute(file, "NumberOfComponents", pos)));
+        success = check(attribute(file, "format", pos) == "appended", "format of a data array") && success;
+        array.offset = std::stoull(attribute(file, "offset", pos));
+        arrays.push_back(array);
+    }
+
+    const std::string marker = "<AppendedData encoding=\"raw\">\n_";
+    size_t dataBegin = file.find(marker);
+    if (!check(dataBegin != std::string::npos, "start of the appended data"))
+        return false;
+    dataBegin += marker.size();
+
+    uint64_t expectedOffset = 0;
+    for (auto& array : arrays) {
+        success = check(array.offset == expectedOffset,
+                        "offset " + std::to_string(array.offset) + " of a data array is not "
+                        + std::to_string(expectedOffset)) && success;
+
+        size_t blockBegin = dataBegin + static_cast<size_t>(array.offset);
+        if (!check(blockBegin + sizeof(uint64_t) <= file.size(), "size of the appended data"))
+            return false;
+
+        uint64_t numBytes;
+        std::memcpy(&numBytes, file.data() + blockBegin, sizeof(numBytes));
+        if (!check(blockBegin + sizeof(numBytes) + numBytes <= file.size(), "size of a binary block"))
+            return false;
+
+        const char* blockData = file.data() + blockBegin + sizeof(numBytes);
+        array.data.assign(blockData, blockData + numBytes);
+        expectedOffset = array.offset + sizeof(numBytes) + numBytes;
+    }
+
+    success = check(file.compare(dataBegin + static_cast<size_t>(expectedOffset),
+                                 std::string::npos,
+                                 "\n </AppendedData>\n</VTKFile>\n") == 0,
+                    "end of the appended data") && success;
+
+    return success;
+}
+
+int main(int argc, char **argv)
+{
+    typedef Dune::YaspGrid<2> Grid;
+    typedef Grid::LeafGridView GridView;
+    typedef Dune::MultipleCodimMultipleGeomTypeMapper<GridView> Mapper;
+    typedef Opm::VtkAppendedRawWriter<GridView, Mapper, Mapper> Writer;
+
+    Dune::MPIHelper::instance(argc, argv);
+
+    const unsigned numX = 3;
+    const unsigned numY = 2;
+    Grid grid(Dune::FieldVector<double, 2>({ 3.0, 2.0 }),
+              std::array<int, 2>{{ static_cast<int>(numX), static_cast<int>(numY) }});
+    const auto& gridView = grid.leafGridView();
+    Mapper elementMapper(gridView, Dune::mcmgElementLayout());
+    Mapper vertexMapper(gridView, Dune::mcmgVertexLayout());
+
+    // the cell data is the index of the element, the point data the position of the
+    // vertex. the two-dimensional vectors get padded to three components.
+    Opm::BaseOutputWriter::ScalarBuffer cellIndices(elementMapper.size());
+    Opm::BaseOutputWriter::VectorBuffer vertexPositions(vertexMapper.size(),
+                                                        Opm::BaseOutputWriter::Vector(2));
+    for (const auto& elem : elements(gridView))
+        cellIndices[elementMapper.index(elem)] = elementMapper.index(elem);
+    for (const auto& vertex : vertices(gridView)) {
+        const auto& pos = vertex.geometry().center();
+        for (unsigned i = 0; i < 2; ++i)
+            vertexPositions[vertexMapper.index(vertex)][i] = pos[i];
+    }
+
+    Writer writer(gridView, elementMapper, vertexMapper, /*compress=*/false);
+    writer.addVectorData(vertexPositions, "position", /*isCellData=*/false);
+    writer.addScalarData(cellIndices, "index", /*isCellData=*/true);
+    std::string fileName = writer.write(".", "test_vtkappendedrawwriter", /*commRank=*/0, /*commSize=*/1);
+
+    std::ifstream is(fileName.c_str(), std::ios::in | std::ios::binary);
+    std::string file((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+
+    bool success = true;
+    size_t pos = 0;
+    const unsigned numPoints = (numX + 1)*(numY + 1);
+    const unsigned numCells = numX*numY;
+    success = check(attribute(file, "NumberOfPoints", pos) == std::to_string(numPoints),
+                    "number of points") && success;
+    success = check(attribute(file, "NumberOfCells", pos) == std::to_string(numCells),
+                    "number of cells") && success;
+
+    std::vector<DataArray> arrays;
+    success = readDataArrays(file, arrays) && success;
+    if (!check(arrays.size() == 6, "number of data arrays"))
+        return 1;
+
+    // the arrays appear in the order point data, cell data, points, connectivity,
+    // offsets and types
+    const DataArray& positions = arrays[0];
+    const DataArray& indices = arrays[1];
+    const DataArray& points = arrays[2];
+    const DataArray& connectivity = arrays[3];
+    const DataArray& offsets = arrays[4];
+    const DataArray& types = arrays[5];
+
+    const std::array<std::pair<const DataArray*, uint64_t>, 6> expectedSizes = {{
+        { &positions, numPoints*3*sizeof(float) },
+        { &indices, numCells*sizeof(float) },
+        { &points, numPoints*3*sizeof(float) },
+        { &connectivity, numCells*4*sizeof(int32_t) },
+        { &offsets, numCells*sizeof(int32_t) },
+        { &types, numCells*sizeof(uint8_t) }
+    }};
+    for (unsigned i = 0; i < expectedSizes.size(); ++i)
+        success = check(expectedSizes[i].first->data.size() == expectedSizes[i].second,
+                        "size of the binary block of data array " + std::to_string(i)) && success;
+    if (!success)
+        return 1;
+
+    success = check(positions.type == "Float32" && positions.numComponents == 3,
+                    "type of the point data") && success;
+    success = check(connectivity.type == "Int32" && types.type == "UInt8",
+                    "types of the cell arrays") && success;
+
+    // the point data must be ordered like the points
+    for (unsigned pointIdx = 0; pointIdx < numPoints; ++pointIdx)
+        for (unsigned i = 0; i < 3; ++i)
+            success = check(positions.value<float>(3*pointIdx + i) == points.value<float>(3*pointIdx + i),
+                            "position of point " + std::to_string(pointIdx)) && success;
+
+    // the vertices of each cell surround its center
+    for (unsigned cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+        success = check(offsets.value<int32_t>(cellIdx) == static_cast<int32_t>(4*(cellIdx + 1)),
+                        "offset of cell " + std::to_string(cellIdx)) && success;
+
+        unsigned elemIdx = static_cast<unsigned>(indices.value<float>(cellIdx));
+        double centerX = (elemIdx % numX) + 0.5;
+        double centerY = (elemIdx / numX) + 0.5;
+        for (unsigned i = 0; i < 4; ++i) {
+            int32_t pointIdx = connectivity.value<int32_t>(4*cellIdx + i);
+            if (!check(0 <= pointIdx && pointIdx < static_cast<int32_t>(numPoints),
+                       "point index of cell " + std::to_string(cellIdx)))
+                return 1;
+            double x = points.value<float>(3*static_cast<unsigned>(pointIdx));
+            double y = points.value<float>(3*static_cast<unsigned>(pointIdx) + 1);
+            success = check(std::abs(std::abs(x - centerX) - 0.5) < 1e-6
+                            && std::abs(std::abs(y - centerY) - 0.5) < 1e-6,
+                            "vertex " + std::to_string(i) + " of cell " + std::to_string(cellIdx))
+                && success;
+        }
+    }
+
+    return success ? 0 : 1;
+}